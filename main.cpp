@@ -4,41 +4,354 @@
 #include <map>
 #include <regex>
 #include <set>
+#include <shared_mutex>
 #include <cmath>
+#include <algorithm>
+#include <memory>
+#include <string_view>
+#include <chrono>
+#include <array>
+#include <queue>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <atomic>
+#include <filesystem>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <iterator>
+#include <list>
+#include <cstdio>
+#include <memory_resource>
+#include <optional>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 using namespace std;
 
-string toLower(const string &s)
+// Heap allocations made by the current thread, counted by the replaced global operator new.
+// The replacements stay out of line so GCC does not flag their malloc/free pairing as mismatched.
+thread_local size_t heap_allocations = 0;
+
+__attribute__((noinline)) void *operator new(size_t size)
+{
+    heap_allocations++;
+    if (void *p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+// Text kernels behind toLower, trimView, split and the all-uppercase header check. Each exists as a
+// scalar version and, on x86, SSE2 and AVX2 versions picked at startup from what the CPU supports.
+// Only ASCII bytes are examined; UTF-8 sequences such as the "•" bullet pass through unchanged.
+struct TextKernels
+{
+    const char *name;
+    void (*to_lower)(const char *in, char *out, size_t n);            // ASCII A-Z to a-z
+    size_t (*find_byte)(const char *data, size_t n, char c);           // first c, or n
+    size_t (*skip_spaces)(const char *data, size_t n);                 // first byte not in " \t\r\n", or n
+    size_t (*skip_spaces_back)(const char *data, size_t n);            // one past the last such byte, or 0
+    bool (*has_lowercase)(const char *data, size_t n);                 // any byte in a-z
+};
+
+inline bool isTrimSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+void scalarToLower(const char *in, char *out, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        out[i] = (in[i] >= 'A' && in[i] <= 'Z') ? static_cast<char>(in[i] + 32) : in[i];
+}
+
+size_t scalarFindByte(const char *data, size_t n, char c)
+{
+    for (size_t i = 0; i < n; i++)
+        if (data[i] == c)
+            return i;
+    return n;
+}
+
+size_t scalarSkipSpaces(const char *data, size_t n)
+{
+    size_t i = 0;
+    while (i < n && isTrimSpace(data[i]))
+        i++;
+    return i;
+}
+
+size_t scalarSkipSpacesBack(const char *data, size_t n)
+{
+    while (n > 0 && isTrimSpace(data[n - 1]))
+        n--;
+    return n;
+}
+
+bool scalarHasLowercase(const char *data, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        if (data[i] >= 'a' && data[i] <= 'z')
+            return true;
+    return false;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Bytes of v in [lo, hi]; bytes >= 0x80 are negative as signed chars and never match
+#define ATS_SSE2_IN_RANGE(v, lo, hi) \
+    _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8((lo) - 1)), _mm_cmpgt_epi8(_mm_set1_epi8((hi) + 1), v))
+#define ATS_SSE2_TRIM_SPACE(v)                                                                       \
+    _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))), \
+                 _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))))
+
+__attribute__((target("sse2"))) void sse2ToLower(const char *in, char *out, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        __m128i upper = ATS_SSE2_IN_RANGE(v, 'A', 'Z');
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(32))));
+    }
+    scalarToLower(in + i, out + i, n - i);
+}
+
+__attribute__((target("sse2"))) size_t sse2FindByte(const char *data, size_t n, char c)
+{
+    __m128i needle = _mm_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i)), needle));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    return i + scalarFindByte(data + i, n - i, c);
+}
+
+__attribute__((target("sse2"))) size_t sse2SkipSpaces(const char *data, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        int other = ~_mm_movemask_epi8(ATS_SSE2_TRIM_SPACE(v)) & 0xFFFF;
+        if (other)
+            return i + __builtin_ctz(other);
+    }
+    return i + scalarSkipSpaces(data + i, n - i);
+}
+
+__attribute__((target("sse2"))) size_t sse2SkipSpacesBack(const char *data, size_t n)
+{
+    while (n >= 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + n - 16));
+        int other = ~_mm_movemask_epi8(ATS_SSE2_TRIM_SPACE(v)) & 0xFFFF;
+        if (other)
+            return n - 16 + (32 - __builtin_clz(other));
+        n -= 16;
+    }
+    return scalarSkipSpacesBack(data, n);
+}
+
+__attribute__((target("sse2"))) bool sse2HasLowercase(const char *data, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        if (_mm_movemask_epi8(ATS_SSE2_IN_RANGE(v, 'a', 'z')))
+            return true;
+    }
+    return scalarHasLowercase(data + i, n - i);
+}
+
+#define ATS_AVX2_IN_RANGE(v, lo, hi) \
+    _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8((lo) - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8((hi) + 1), v))
+#define ATS_AVX2_TRIM_SPACE(v)                                                                                        \
+    _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))), \
+                    _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))))
+
+__attribute__((target("avx2"))) void avx2ToLower(const char *in, char *out, size_t n)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+        __m256i upper = ATS_AVX2_IN_RANGE(v, 'A', 'Z');
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                            _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(32))));
+    }
+    sse2ToLower(in + i, out + i, n - i);
+}
+
+__attribute__((target("avx2"))) size_t avx2FindByte(const char *data, size_t n, char c)
+{
+    __m256i needle = _mm256_set1_epi8(c);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)), needle)));
+        if (mask)
+            return i + __builtin_ctz(mask);
+    }
+    return i + sse2FindByte(data + i, n - i, c);
+}
+
+__attribute__((target("avx2"))) size_t avx2SkipSpaces(const char *data, size_t n)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        unsigned other = ~static_cast<unsigned>(_mm256_movemask_epi8(ATS_AVX2_TRIM_SPACE(v)));
+        if (other)
+            return i + __builtin_ctz(other);
+    }
+    return i + sse2SkipSpaces(data + i, n - i);
+}
+
+__attribute__((target("avx2"))) size_t avx2SkipSpacesBack(const char *data, size_t n)
+{
+    while (n >= 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + n - 32));
+        unsigned other = ~static_cast<unsigned>(_mm256_movemask_epi8(ATS_AVX2_TRIM_SPACE(v)));
+        if (other)
+            return n - 32 + (32 - __builtin_clz(other));
+        n -= 32;
+    }
+    return sse2SkipSpacesBack(data, n);
+}
+
+__attribute__((target("avx2"))) bool avx2HasLowercase(const char *data, size_t n)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        if (_mm256_movemask_epi8(ATS_AVX2_IN_RANGE(v, 'a', 'z')))
+            return true;
+    }
+    return sse2HasLowercase(data + i, n - i);
+}
+#endif
+
+// Every kernel set this CPU can run, fastest last
+const vector<TextKernels> &availableTextKernels()
+{
+    static const vector<TextKernels> kernels = []
+    {
+        vector<TextKernels> list = {{"scalar", scalarToLower, scalarFindByte, scalarSkipSpaces, scalarSkipSpacesBack,
+                                     scalarHasLowercase}};
+#if defined(__x86_64__) || defined(__i386__)
+        if (__builtin_cpu_supports("sse2"))
+            list.push_back({"sse2", sse2ToLower, sse2FindByte, sse2SkipSpaces, sse2SkipSpacesBack, sse2HasLowercase});
+        if (__builtin_cpu_supports("avx2"))
+            list.push_back({"avx2", avx2ToLower, avx2FindByte, avx2SkipSpaces, avx2SkipSpacesBack, avx2HasLowercase});
+#endif
+        return list;
+    }();
+    return kernels;
+}
+
+// The kernel set used by the analyzer
+inline const TextKernels &textKernels()
+{
+    static const TextKernels &best = availableTextKernels().back();
+    return best;
+}
+
+string toLower(string_view s)
 {
-    string result = s;
-    transform(result.begin(), result.end(), result.begin(), ::tolower);
+    string result(s.size(), '\0');
+    textKernels().to_lower(s.data(), result.data(), s.size());
     return result;
 }
 
-string trim(const string &s)
+// Same as trim but returns a view into s instead of a copy
+string_view trimView(string_view s)
+{
+    const TextKernels &kernels = textKernels();
+    size_t start = kernels.skip_spaces(s.data(), s.size());
+    if (start == s.size())
+        return {};
+    size_t end = kernels.skip_spaces_back(s.data(), s.size());
+    return s.substr(start, end - start);
+}
+
+string trim(string_view s)
 {
-    int start = s.find_first_not_of(" \t\r\n");
-    int end = s.find_last_not_of(" \t\r\n");
-    if (start == string::npos)
-        return "";
-    return s.substr(start, end - start + 1);
+    return string(trimView(s));
 }
 
-vector<string> split(const string &s, char separator)
+// Split like repeated getline calls (no empty token after a trailing separator), returning views into s
+pmr::vector<string_view> split(string_view s, char separator, pmr::memory_resource *memory = pmr::get_default_resource())
 {
-    vector<string> tokens;
-    string token;
-    istringstream tokenStream(s);
-    while (getline(tokenStream, token, separator))
-        tokens.push_back(token);
+    const TextKernels &kernels = textKernels();
+    pmr::vector<string_view> tokens(memory);
+    tokens.reserve(count(s.begin(), s.end(), separator) + 1);
+    while (!s.empty())
+    {
+        size_t pos = kernels.find_byte(s.data(), s.size(), separator);
+        tokens.push_back(s.substr(0, pos));
+        if (pos == s.size())
+            break;
+        s.remove_prefix(pos + 1);
+    }
     return tokens;
 }
 
+// Non-empty, trimmed items of a comma-separated list
+vector<string> splitList(string_view list)
+{
+    vector<string> items;
+    for (auto item : split(list, ','))
+        if (!trimView(item).empty())
+            items.push_back(trim(item));
+    return items;
+}
+
 // Structure to hold keyword matching results
 struct KeywordMatchResult
 {
     double score;
     vector<string> found_skills;
     vector<string> missing_skills;
+    // BM25 relevance (0-100) to the job description, or -1 when the job has none or its corpus cannot
+    // weigh the description's terms yet; unscored until scoreDocument fills it in
+    static constexpr int unscored = -2;
+    int relevance = unscored;
 };
 
 // Structure to hold personal information extracted from a resume
@@ -53,6 +366,42 @@ struct PersonalInfo
     string codeforces;
 };
 
+// Structure to hold the education, experience and project entries found in a resume
+struct ResumeSections
+{
+    vector<string> education;
+    vector<string> experience;
+    vector<string> projects;
+};
+
+// Structure to hold the weight of each component in the final ATS score
+struct ScoringWeights
+{
+    double contact = 0.1;
+    double skills = 0.35;
+    double experience = 0.25;
+    double education = 0.1;
+    double format = 0.2;
+    double relevance = 0.5; // share of BM25 relevance in the skills component when the job has a description
+};
+
+// Structure to hold one job posting's requirements
+struct JobRequirements
+{
+    vector<string> required_skills;
+    bool require_gpa = false;
+    ScoringWeights weights;
+    string description; // full job posting text; when set, resumes are also ranked by BM25 relevance to it
+};
+
+// Structure to hold the counters of a top-K ranking
+struct RankingStats
+{
+    size_t candidates = 0;
+    size_t fully_analyzed = 0;
+    size_t skipped = 0;
+};
+
 // Structure to hold the complete resume analysis result
 struct ResumeAnalysisResult
 {
@@ -71,569 +420,7793 @@ struct ResumeAnalysisResult
     map<string, int> section_scores; // Keys: contact, summary, skills, experience, education, format
 };
 
-class ResumeAnalyzer
+// Section scores in a fixed order, replacing the section_scores map keys in compact encodings
+enum SectionScore
 {
-private:
-    vector<string> file;
+    SCORE_CONTACT,
+    SCORE_SKILLS,
+    SCORE_EXPERIENCE,
+    SCORE_EDUCATION,
+    SCORE_FORMAT,
+    SECTION_SCORE_COUNT
+};
 
-public:
-    ResumeAnalyzer()
+const char *const section_score_names[SECTION_SCORE_COUNT] = {"contact", "skills", "experience", "education", "format"};
+
+// Structure to hold one resume of a ranking: its position in the input and its analysis
+struct RankedResume
+{
+    size_t index;
+    ResumeAnalysisResult result;
+};
+
+// Character classes used by the contact scanners (same as \w, \d and \s for std::regex in the "C" locale)
+constexpr bool isWordChar(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+inline bool isDigitChar(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool isSpaceChar(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline bool isEmailChar(char c)
+{
+    return isWordChar(c) || c == '.' || c == '-';
+}
+
+// True if position pos of text sits on a word boundary (\b)
+inline bool isWordBoundary(string_view text, size_t pos)
+{
+    bool before = pos > 0 && isWordChar(text[pos - 1]);
+    bool after = pos < text.size() && isWordChar(text[pos]);
+    return before != after;
+}
+
+// Match the domain part of an email ([\w\.-]+\.\w+) starting at pos; returns the end of the match or npos
+size_t matchEmailDomain(string_view text, size_t pos)
+{
+    size_t run_end = pos;
+    while (run_end < text.size() && isEmailChar(text[run_end]))
+        run_end++;
+    // The greedy [\w\.-]+ backtracks to the last '.' that is followed by a word character
+    for (size_t dot = run_end; dot-- > pos + 1;)
     {
-        file = {"experience", "education", "skills", "work", "project", "objective",
-                "summary", "employment", "qualification", "achievements"};
+        if (text[dot] == '.' && dot + 1 < run_end && isWordChar(text[dot + 1]))
+        {
+            size_t end = dot + 1;
+            while (end < text.size() && isWordChar(text[end]))
+                end++;
+            return end;
+        }
     }
+    return string::npos;
+}
 
-    // Calculate how many required skills are matched in the resume text
-    KeywordMatchResult calculateKeywordMatch(string resume_text, const vector<string> &required_skills)
+// Find the leftmost email address ([\w\.-]+@[\w\.-]+\.\w+); with word_bounded the match must start on \b
+string_view scanEmail(string_view text, bool word_bounded = false)
+{
+    size_t i = 0;
+    while (i < text.size())
     {
-        string lower_text = toLower(resume_text);
-        KeywordMatchResult result;
-        for (const auto &skill : required_skills)
+        if (!isEmailChar(text[i]))
         {
-            string skill_lower = toLower(skill);
-            if (lower_text.find(skill_lower) != string::npos)
-            {
-                result.found_skills.push_back(skill);
-            }
-            else
-            {
-                // Check for partial match by splitting the text into sentences (using period as delimiter)
-                vector<string> sentences = split(lower_text, '.');
-                bool found = false;
-                for (auto &sentence : sentences)
-                {
-                    if (sentence.find(skill_lower) != string::npos)
-                    {
-                        found = true;
-                        break;
-                    }
-                }
-                if (found)
-                    result.found_skills.push_back(skill);
-                else
-                    result.missing_skills.push_back(skill);
-            }
+            i++;
+            continue;
         }
-        if (!required_skills.empty())
-            result.score = (static_cast<double>(result.found_skills.size()) / required_skills.size()) * 100;
-        else
-            result.score = 0;
-        return result;
+        size_t run_start = i;
+        while (i < text.size() && isEmailChar(text[i]))
+            i++;
+        if (i >= text.size() || text[i] != '@')
+            continue;
+        size_t end = matchEmailDomain(text, i + 1);
+        if (end == string::npos)
+            continue;
+        size_t start = run_start;
+        if (word_bounded)
+        {
+            while (start < i && !isWordBoundary(text, start))
+                start++;
+            if (start == i)
+                continue;
+        }
+        return text.substr(start, end - start);
     }
+    return {};
+}
 
-    // Check for essential resume sections and compute a total section score (max 100)
-    int checkResumeSections(const string &text)
-    {
-        string lower_text = toLower(text);
-        map<string, vector<string>> essential_sections = {
-            {"contact", {"email", "phone", "address", "linkedin"}},
-            {"education", {"education", "university", "college", "degree", "academic"}},
-            {"experience", {"experience", "internship", "work", "position of responsibility"}},
-            {"skills", {"skills", "technologies", "tools", "expertise"}}};
-        int total_score = 0;
-        for (auto &kv : essential_sections)
+// Match "\(?\d{3}\)?[-.]?\s*\d{3}[-.]?\s*\d{4}" preceded by \s* at pos; returns the end of the match or npos
+size_t matchPhoneBody(string_view text, size_t pos)
+{
+    size_t n = text.size();
+    auto digits = [&](size_t count)
+    {
+        for (size_t k = 0; k < count; k++, pos++)
+            if (pos >= n || !isDigitChar(text[pos]))
+                return false;
+        return true;
+    };
+    auto skipSpaces = [&]()
+    {
+        while (pos < n && isSpaceChar(text[pos]))
+            pos++;
+    };
+    auto optional = [&](char a, char b)
+    {
+        if (pos < n && (text[pos] == a || text[pos] == b))
+            pos++;
+    };
+    skipSpaces();
+    optional('(', '(');
+    if (!digits(3))
+        return string::npos;
+    optional(')', ')');
+    optional('-', '.');
+    skipSpaces();
+    if (!digits(3))
+        return string::npos;
+    optional('-', '.');
+    skipSpaces();
+    if (!digits(4))
+        return string::npos;
+    return pos;
+}
+
+// Find the leftmost phone number ((\+\d{1,3}[-.]?)?\s*\(?\d{3}\)?[-.]?\s*\d{3}[-.]?\s*\d{4}), trying only
+// starts before start_limit; the match itself may run past it
+string_view scanPhone(string_view text, size_t start_limit = string_view::npos)
+{
+    size_t n = text.size();
+    for (size_t i = 0; i < n && i < start_limit; i++)
+    {
+        // Optional country code, trying the longest digit run first like the greedy \d{1,3}
+        if (text[i] == '+')
         {
-            const vector<string> &keywords = kv.second;
-            int found = 0;
-            for (const auto &keyword : keywords)
+            size_t code_digits = 0;
+            while (code_digits < 3 && i + 1 + code_digits < n && isDigitChar(text[i + 1 + code_digits]))
+                code_digits++;
+            for (size_t k = code_digits; k >= 1; k--)
             {
-                if (lower_text.find(keyword) != string::npos)
-                    found++;
+                size_t pos = i + 1 + k;
+                if (pos < n && (text[pos] == '-' || text[pos] == '.'))
+                    pos++;
+                size_t end = matchPhoneBody(text, pos);
+                if (end != string::npos)
+                    return text.substr(i, end - i);
             }
-            int section_score = min(25, static_cast<int>((static_cast<double>(found) / keywords.size()) * 25));
-            total_score += section_score;
+            continue;
+        }
+        size_t end = matchPhoneBody(text, i);
+        if (end != string::npos)
+            return text.substr(i, end - i);
+        // Every start inside a whitespace run reaches the same body, so skip to its end
+        if (isSpaceChar(text[i]))
+        {
+            while (i + 1 < n && isSpaceChar(text[i + 1]))
+                i++;
         }
-        return total_score;
     }
+    return {};
+}
 
-    // Check formatting and return a score (out of 100) and a list of deduction messages
-    pair<int, vector<string>> checkFormatting(const string &text)
+// True if text contains a standalone 10 digit phone number (\b\d{3}[-.]?\d{3}[-.]?\d{4}\b)
+bool containsPlainPhone(string_view text)
+{
+    size_t n = text.size();
+    for (size_t i = 0; i < n; i++)
     {
-        vector<string> deductions;
-        int score = 100;
-        // Check minimum content length
-        if (text.size() < 300)
-        {
-            score -= 30;
-            deductions.push_back("Resume is too short");
-        }
-        // Split text into lines
-        vector<string> lines;
-        istringstream iss(text);
-        string line;
-        while (getline(iss, line))
-            lines.push_back(line);
-        // Check for section headers (look for lines that are all uppercase)
-        bool hasSectionHeader = false;
-        for (const auto &ln : lines)
+        if (!isDigitChar(text[i]) || (i > 0 && isWordChar(text[i - 1])))
+            continue;
+        size_t pos = i;
+        bool ok = true;
+        for (size_t group : {3, 3, 4})
         {
-            string trimmed = trim(ln);
-            if (!trimmed.empty() &&
-                all_of(trimmed.begin(), trimmed.end(), [](char c)
-                       { return !isalpha(c) || isupper(c); }))
+            for (size_t k = 0; k < group && ok; k++, pos++)
+                ok = pos < n && isDigitChar(text[pos]);
+            if (group == 3 && ok && pos < n && (text[pos] == '-' || text[pos] == '.'))
+                pos++;
+        }
+        if (ok && (pos >= n || !isWordChar(text[pos])))
+            return true;
+    }
+    return false;
+}
+
+// Find "<prefix>" followed by one or more [\w-] (or \w when allow_hyphen is false) characters
+string_view scanProfileUrl(string_view text, string_view prefix, bool allow_hyphen = true)
+{
+    size_t pos = text.find(prefix);
+    while (pos != string::npos)
+    {
+        size_t end = pos + prefix.size();
+        while (end < text.size() && (isWordChar(text[end]) || (allow_hyphen && text[end] == '-')))
+            end++;
+        if (end > pos + prefix.size())
+            return text.substr(pos, end - pos);
+        pos = text.find(prefix, pos + 1);
+    }
+    return {};
+}
+
+// Aho-Corasick automaton over lowercase keywords; ASCII letters are matched case-insensitively like toLower
+class KeywordAutomaton
+{
+private:
+    array<int, 256> byte_class{};
+    int alphabet_size = 1;
+    vector<int> transitions; // state * alphabet_size + class -> next state
+    vector<int> fail;
+    vector<int> bfs_order;
+    vector<int> keyword_states;
+
+public:
+    KeywordAutomaton() : KeywordAutomaton(vector<string>{}) {}
+
+    explicit KeywordAutomaton(const vector<string> &keywords)
+    {
+        // Only bytes that occur in a keyword get their own class, everything else shares class 0
+        for (const auto &keyword : keywords)
+            for (char c : keyword)
             {
-                hasSectionHeader = true;
-                break;
+                unsigned char b = static_cast<unsigned char>(c);
+                if (byte_class[b] == 0)
+                    byte_class[b] = alphabet_size++;
             }
-        }
-        if (!hasSectionHeader)
-        {
-            score -= 20;
-            deductions.push_back("No clear section headers found");
-        }
-        // Check for bullet points in lines
-        bool hasBullets = false;
-        for (const auto &ln : lines)
+        for (int c = 'A'; c <= 'Z'; c++)
+            byte_class[c] = byte_class[c - 'A' + 'a'];
+
+        transitions.assign(alphabet_size, -1);
+        for (const auto &keyword : keywords)
         {
-            string trimmed = trim(ln);
-            if (!trimmed.empty())
+            int state = 0;
+            for (char c : keyword)
             {
-                if (trimmed[0] == '-' || trimmed[0] == '*') // Handle single-byte characters
+                size_t slot = state * alphabet_size + byte_class[static_cast<unsigned char>(c)];
+                if (transitions[slot] == -1)
                 {
-                    hasBullets = true;
-                    break;
+                    transitions[slot] = static_cast<int>(transitions.size() / alphabet_size);
+                    transitions.resize(transitions.size() + alphabet_size, -1);
                 }
-                else if (trimmed.substr(0, 3) == "•" || trimmed.substr(0, 3) == "→") // Handle multi-byte characters
+                state = transitions[slot];
+            }
+            keyword_states.push_back(state);
+        }
+
+        // Breadth-first pass filling failure links and turning the trie into a full DFA
+        int states = static_cast<int>(transitions.size() / alphabet_size);
+        fail.assign(states, 0);
+        queue<int> pending;
+        pending.push(0);
+        while (!pending.empty())
+        {
+            int state = pending.front();
+            pending.pop();
+            bfs_order.push_back(state);
+            for (int c = 0; c < alphabet_size; c++)
+            {
+                int &slot = transitions[state * alphabet_size + c];
+                int fallback = state == 0 ? 0 : transitions[fail[state] * alphabet_size + c];
+                if (slot == -1)
                 {
-                    hasBullets = true;
-                    break;
+                    slot = fallback;
+                    continue;
                 }
+                fail[slot] = fallback;
+                pending.push(slot);
             }
         }
-        if (!hasBullets)
+    }
+
+    int next(int state, char c) const
+    {
+        return transitions[state * alphabet_size + byte_class[static_cast<unsigned char>(c)]];
+    }
+
+    size_t stateCount() const { return fail.size(); }
+    int failure(int state) const { return fail[state]; }
+    int keywordState(size_t id) const { return keyword_states[id]; }
+    size_t keywordCount() const { return keyword_states.size(); }
+    // States ordered by depth, so walking it backwards visits every state before its failure link
+    const vector<int> &breadthFirstOrder() const { return bfs_order; }
+
+    // Mark the states of all keywords that occur anywhere in text
+    pmr::vector<char> scan(string_view text, pmr::memory_resource *memory = pmr::get_default_resource()) const
+    {
+        pmr::vector<char> seen(stateCount(), 0, memory);
+        int state = 0;
+        seen[0] = 1;
+        for (char c : text)
         {
-            score -= 20;
-            deductions.push_back("No bullet points found for listing details");
+            state = next(state, c);
+            seen[state] = 1;
         }
-        // Check for inconsistent spacing: consecutive empty lines
-        for (int i = 0; i < lines.size() - 1; i++)
+        for (auto it = bfs_order.rbegin(); it != bfs_order.rend(); ++it)
+            if (seen[*it])
+                seen[fail[*it]] = 1;
+        return seen;
+    }
+};
+
+// The skills component of the ATS score (0-100) for a resume containing found of total required skills
+int skillsScore(size_t found, size_t total)
+{
+    if (total == 0)
+        return 0;
+    return static_cast<int>((static_cast<double>(found) / total) * 100);
+}
+
+// KeywordMatchResult::score for a resume containing found of total required skills
+double keywordScore(size_t found, size_t total)
+{
+    if (total == 0)
+        return 0;
+    return (static_cast<double>(found) / total) * 100;
+}
+
+// Found and missing lists of skills, in their given order, when is_found(i) tells whether skill i occurs
+template <typename IsFound>
+KeywordMatchResult keywordMatchFor(const vector<string> &skills, IsFound is_found)
+{
+    KeywordMatchResult result;
+    for (size_t i = 0; i < skills.size(); i++)
+    {
+        if (is_found(i))
+            result.found_skills.push_back(skills[i]);
+        else
+            result.missing_skills.push_back(skills[i]);
+    }
+    result.score = keywordScore(result.found_skills.size(), skills.size());
+    return result;
+}
+
+// A job's required skills compiled once and reusable for any number of resumes
+class SkillMatcher
+{
+private:
+    vector<string> required_skills;
+    KeywordAutomaton automaton;
+
+    static vector<string> lowered(const vector<string> &skills)
+    {
+        vector<string> result;
+        for (const auto &skill : skills)
+            result.push_back(toLower(skill));
+        return result;
+    }
+
+public:
+    explicit SkillMatcher(const vector<string> &skills) : required_skills(skills), automaton(lowered(skills)) {}
+
+    const vector<string> &skills() const { return required_skills; }
+
+    // The skills component of the ATS score (0-100) for a resume containing found of the skills
+    int scoreFor(size_t found) const
+    {
+        return skillsScore(found, required_skills.size());
+    }
+
+    // Number of required skills found in text, without building the found/missing lists
+    size_t countMatches(string_view text, pmr::memory_resource *memory = pmr::get_default_resource()) const
+    {
+        pmr::vector<char> seen = automaton.scan(text, memory);
+        size_t found = 0;
+        for (size_t i = 0; i < required_skills.size(); i++)
+            found += seen[automaton.keywordState(i)] != 0;
+        return found;
+    }
+
+    // Same result as searching the lowercased text for every lowercased skill, in one pass over the text
+    KeywordMatchResult match(string_view text, pmr::memory_resource *memory = pmr::get_default_resource()) const
+    {
+        pmr::vector<char> seen = automaton.scan(text, memory);
+        return resultFor([&](size_t i)
+                         { return seen[automaton.keywordState(i)] != 0; });
+    }
+
+    // Call found(i) for every skill index i that occurs in text
+    template <typename Found>
+    void forEachFound(string_view text, Found found, pmr::memory_resource *memory = pmr::get_default_resource()) const
+    {
+        pmr::vector<char> seen = automaton.scan(text, memory);
+        for (size_t i = 0; i < required_skills.size(); i++)
+            if (seen[automaton.keywordState(i)])
+                found(i);
+    }
+
+    // The match result when is_found(i) tells whether skill i occurs in the resume
+    template <typename IsFound>
+    KeywordMatchResult resultFor(IsFound is_found) const
+    {
+        return keywordMatchFor(required_skills, is_found);
+    }
+};
+
+// Term characters for relevance scoring (letters, digits, '_', and '+' and '#' so that c++ and c# stay
+// whole) mapped to their lowercase form; every other byte maps to 0
+constexpr array<char, 256> term_chars = []
+{
+    array<char, 256> table{};
+    for (int c = 0; c < 256; c++)
+        if (isWordChar(static_cast<char>(c)) || c == '+' || c == '#')
+            table[c] = static_cast<char>(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+    return table;
+}();
+
+// Call word(term, hash) for every lowercased word of text, split on word boundaries so that "java" never
+// matches inside "javascript"; hash is the term's FNV-1a hash. Words longer than max_term_bytes (URLs,
+// hashes) are passed as empty terms so they still count towards the document length. Unlike the search
+// index's forEachTerm, '.' and '-' always split ("node.js" is two terms) and non-ASCII bytes are not
+// term characters, which keeps relevance scoring a single table lookup per byte.
+template <typename Word>
+void forEachRelevanceTerm(string_view text, Word word)
+{
+    constexpr size_t max_term_bytes = 48;
+    char lower[max_term_bytes];
+    size_t i = 0;
+    while (i < text.size())
+    {
+        while (i < text.size() && !term_chars[static_cast<unsigned char>(text[i])])
+            i++;
+        size_t start = i;
+        while (i < text.size() && term_chars[static_cast<unsigned char>(text[i])])
+            i++;
+        if (i == start)
+            break;
+        if (i - start > max_term_bytes)
+        {
+            word(string_view(), uint64_t(0));
+            continue;
+        }
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (size_t k = start; k < i; k++)
+        {
+            char c = term_chars[static_cast<unsigned char>(text[k])];
+            lower[k - start] = c;
+            hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001B3ull;
+        }
+        word(string_view(lower, i - start), hash);
+    }
+}
+
+// Open-addressing map from terms to dense ids 0, 1, 2, ... in insertion order, probed by the hash
+// forEachRelevanceTerm computed for the term
+class TermTable
+{
+private:
+    static constexpr uint32_t empty_slot = UINT32_MAX;
+    struct Slot
+    {
+        uint64_t hash;
+        uint32_t id;
+    };
+    vector<Slot> slots = vector<Slot>(16, Slot{0, empty_slot});
+    vector<string> spellings;
+
+    size_t probe(string_view term, uint64_t hash) const
+    {
+        size_t mask = slots.size() - 1;
+        size_t i = hash & mask;
+        while (slots[i].id != empty_slot && (slots[i].hash != hash || spellings[slots[i].id] != term))
+            i = (i + 1) & mask;
+        return i;
+    }
+
+public:
+    static constexpr uint32_t npos = empty_slot;
+
+    size_t size() const { return spellings.size(); }
+
+    uint32_t find(string_view term, uint64_t hash) const
+    {
+        return slots[probe(term, hash)].id;
+    }
+
+    // The id of term, added if new
+    uint32_t insert(string_view term, uint64_t hash)
+    {
+        size_t i = probe(term, hash);
+        if (slots[i].id != empty_slot)
+            return slots[i].id;
+        uint32_t id = static_cast<uint32_t>(spellings.size());
+        spellings.emplace_back(term);
+        slots[i] = {hash, id};
+        // Keep the table at most half full
+        if (2 * spellings.size() > slots.size())
+        {
+            vector<Slot> old(2 * slots.size(), Slot{0, empty_slot});
+            old.swap(slots);
+            for (const Slot &slot : old)
+                if (slot.id != empty_slot)
+                    slots[probe(spellings[slot.id], slot.hash)] = slot;
+        }
+        return id;
+    }
+};
+
+// Document frequencies of every term over the resumes seen so far, for BM25's inverse document frequency.
+// Documents are added one at a time; any number of threads may add and read at once.
+class RelevanceCorpus
+{
+private:
+    mutable shared_mutex lock;
+    TermTable vocabulary;
+    vector<uint32_t> document_frequency;
+    vector<uint64_t> last_document; // per term: the last document counted in its frequency
+    atomic<uint64_t> documents{0};  // written under the exclusive lock, read without it
+    uint64_t total_terms = 0;
+
+public:
+    // Corpus size and average document length at the time term weights were computed
+    struct Snapshot
+    {
+        uint64_t documents;
+        double average_length;
+    };
+
+    // The id of term (hashed as forEachRelevanceTerm does), added to the vocabulary if new
+    uint32_t intern(string_view term, uint64_t hash)
+    {
+        unique_lock<shared_mutex> guard(lock);
+        uint32_t id = vocabulary.insert(term, hash);
+        document_frequency.resize(vocabulary.size());
+        return id;
+    }
+
+    // Count one more document. Known terms are looked up under a shared lock; only new terms and the
+    // counts take it exclusively.
+    void addDocument(string_view text)
+    {
+        vector<uint32_t> ids;
+        vector<pair<string, uint64_t>> unknown;
+        uint32_t term_count = 0;
+        {
+            shared_lock<shared_mutex> guard(lock);
+            forEachRelevanceTerm(text, [&](string_view term, uint64_t hash)
+                                 {
+                                     term_count++;
+                                     if (term.empty())
+                                         return;
+                                     uint32_t id = vocabulary.find(term, hash);
+                                     if (id != TermTable::npos)
+                                         ids.push_back(id);
+                                     else
+                                         unknown.emplace_back(term, hash); });
+        }
+        unique_lock<shared_mutex> guard(lock);
+        for (const auto &[term, hash] : unknown)
+            ids.push_back(vocabulary.insert(term, hash));
+        document_frequency.resize(vocabulary.size());
+        last_document.resize(vocabulary.size(), 0);
+        uint64_t document = ++documents;
+        for (uint32_t id : ids)
+            if (last_document[id] != document)
+            {
+                last_document[id] = document;
+                document_frequency[id]++;
+            }
+        total_terms += term_count;
+    }
+
+    uint64_t documentCount() const { return documents.load(memory_order_acquire); }
+
+    // BM25 inverse document frequency of each term; always positive, so a term found in every document
+    // still adds a little. Also gives the document frequencies themselves when asked.
+    vector<double> idf(const vector<uint32_t> &terms, Snapshot *snapshot = nullptr,
+                       vector<uint32_t> *frequencies = nullptr) const
+    {
+        shared_lock<shared_mutex> guard(lock);
+        vector<double> weights;
+        weights.reserve(terms.size());
+        for (uint32_t term : terms)
+        {
+            double df = document_frequency[term];
+            weights.push_back(log(1.0 + (documents - df + 0.5) / (df + 0.5)));
+            if (frequencies)
+                frequencies->push_back(document_frequency[term]);
+        }
+        if (snapshot)
+            *snapshot = {documents, documents ? static_cast<double>(total_terms) / documents : 0.0};
+        return weights;
+    }
+};
+
+// BM25 relevance of resumes to one job description, scaled to 0-100. The description is a sparse vector
+// of term ids whose weights (idf times the number of times the description uses the term) are cached and
+// only recomputed once the corpus has grown by a twentieth since they were taken, so scoring a resume is
+// one pass over its words counting the description's terms.
+class RelevanceModel
+{
+private:
+    shared_ptr<RelevanceCorpus> corpus;
+    TermTable term_index;          // description term -> index into terms; scoring never takes the corpus lock
+    vector<uint32_t> terms;        // the description's term ids in the corpus
+    vector<uint32_t> query_counts; // times the description uses each term
+
+    struct Weights
+    {
+        uint64_t documents = 0;
+        double average_length = 0;
+        vector<double> term_weights;
+        double reference = 0; // score of an average-length resume using each term the corpus knows once
+    };
+    mutable mutex weights_lock;
+    mutable shared_ptr<const Weights> cached;
+    static constexpr uint64_t refresh_growth = 20; // refresh after the corpus grows by 1/refresh_growth
+
+    shared_ptr<const Weights> weights() const
+    {
+        uint64_t documents = corpus->documentCount();
+        lock_guard<mutex> guard(weights_lock);
+        // Weights barely move once the corpus is large, so a stream refreshes them a logarithmic number of times
+        if (cached && documents < cached->documents + max<uint64_t>(1, cached->documents / refresh_growth))
+            return cached;
+        auto fresh = make_shared<Weights>();
+        RelevanceCorpus::Snapshot snapshot;
+        vector<uint32_t> frequencies;
+        fresh->term_weights = corpus->idf(terms, &snapshot, &frequencies);
+        fresh->documents = snapshot.documents;
+        fresh->average_length = snapshot.average_length;
+        for (size_t i = 0; i < terms.size(); i++)
+        {
+            fresh->term_weights[i] *= query_counts[i];
+            // A term no resume uses yet cannot tell resumes apart, so it does not lower everyone's score
+            if (frequencies[i] > 0)
+                fresh->reference += fresh->term_weights[i];
+        }
+        cached = fresh;
+        return cached;
+    }
+
+public:
+    static constexpr double k1 = 1.2;
+    static constexpr double b = 0.75;
+
+    RelevanceModel(shared_ptr<RelevanceCorpus> shared_corpus, string_view description) : corpus(move(shared_corpus))
+    {
+        forEachRelevanceTerm(description, [&](string_view term, uint64_t hash)
+                             {
+                                 if (term.empty())
+                                     return;
+                                 uint32_t i = term_index.insert(term, hash);
+                                 if (i == terms.size())
+                                 {
+                                     terms.push_back(corpus->intern(term, hash));
+                                     query_counts.push_back(0);
+                                 }
+                                 query_counts[i]++; });
+    }
+
+    // Relevance (0-100) of a resume's text: 100 for a resume of average length using each description term
+    // found in the corpus about once (or fewer terms more often); -1 while the corpus uses none of them
+    int score(string_view text) const
+    {
+        vector<uint32_t> counts(terms.size(), 0);
+        uint32_t length = 0;
+        forEachRelevanceTerm(text, [&](string_view term, uint64_t hash)
+                             {
+                                 length++;
+                                 uint32_t i = term_index.find(term, hash);
+                                 if (i != TermTable::npos)
+                                     counts[i]++; });
+        shared_ptr<const Weights> w = weights();
+        // No resume in the corpus uses a description term yet, so there is nothing to compare against
+        if (w->reference <= 0)
+            return -1;
+        double average = w->average_length > 0 ? w->average_length : max(length, 1u);
+        double norm = k1 * (1 - b + b * length / average);
+        double score = 0;
+        for (size_t i = 0; i < terms.size(); i++)
+            if (counts[i])
+                score += w->term_weights[i] * counts[i] * (k1 + 1) / (counts[i] + norm);
+        return static_cast<int>(min(100.0, round(100 * score / w->reference)));
+    }
+};
+
+// A job compiled once for scoring many resumes: its skill matcher, GPA requirement, scoring weights and,
+// if it has a description, its relevance model
+class JobProfile
+{
+private:
+    SkillMatcher matcher;
+    bool gpa_required;
+    ScoringWeights score_weights;
+    shared_ptr<const RelevanceModel> relevance_model;
+
+public:
+    // A job with a description takes its idf statistics from corpus. Without a corpus there is nothing to
+    // weigh the description's terms by, so the description is not used and relevance stays -1.
+    explicit JobProfile(const JobRequirements &requirements, shared_ptr<RelevanceCorpus> corpus = nullptr)
+        : matcher(requirements.required_skills), gpa_required(requirements.require_gpa), score_weights(requirements.weights)
+    {
+        if (!requirements.description.empty() && corpus)
+            relevance_model = make_shared<const RelevanceModel>(move(corpus), requirements.description);
+    }
+
+    JobProfile(const vector<string> &required_skills, bool require_gpa, ScoringWeights weights = ScoringWeights())
+        : matcher(required_skills), gpa_required(require_gpa), score_weights(weights) {}
+
+    const SkillMatcher &skills() const { return matcher; }
+    bool requireGpa() const { return gpa_required; }
+    const ScoringWeights &weights() const { return score_weights; }
+    const RelevanceModel *relevance() const { return relevance_model.get(); }
+
+    // The skills component (0-100): the share of required skills found, blended with the BM25 relevance
+    // when the job has a description
+    int skillsComponent(double keyword_score, int relevance) const
+    {
+        if (relevance < 0)
+            return static_cast<int>(keyword_score);
+        return static_cast<int>(round(keyword_score * (1 - score_weights.relevance) + relevance * score_weights.relevance));
+    }
+};
+
+// A set of interned skill ids, one bit per id
+class SkillSet
+{
+private:
+    vector<uint64_t> words;
+
+public:
+    void insert(uint32_t id)
+    {
+        if (id / 64 >= words.size())
+            words.resize(id / 64 + 1);
+        words[id / 64] |= 1ull << (id % 64);
+    }
+
+    bool contains(uint32_t id) const { return id / 64 < words.size() && ((words[id / 64] >> (id % 64)) & 1); }
+
+    size_t size() const
+    {
+        size_t count = 0;
+        for (uint64_t word : words)
+            count += __builtin_popcountll(word);
+        return count;
+    }
+
+    // Number of ids in both sets: popcount of the AND of their words
+    size_t intersectionSize(const SkillSet &other) const
+    {
+        size_t count = 0;
+        for (size_t i = 0, n = min(words.size(), other.words.size()); i < n; i++)
+            count += __builtin_popcountll(words[i] & other.words[i]);
+        return count;
+    }
+};
+
+// Interns skills from any number of jobs into dense ids (case-insensitively, like SkillMatcher) and reduces
+// a resume to the SkillSet of every interned skill it contains in a single pass, so matching a resume
+// against many jobs costs one scan plus a popcount per job. Call compile() after interning and before scan().
+class SkillDictionary
+{
+private:
+    unordered_map<string, uint32_t> ids;
+    vector<string> names; // lowercase skill of each id
+    unique_ptr<KeywordAutomaton> automaton;
+
+public:
+    uint32_t intern(string_view skill)
+    {
+        string key = toLower(skill);
+        auto inserted = ids.emplace(key, static_cast<uint32_t>(names.size()));
+        if (inserted.second)
+        {
+            names.push_back(key);
+            automaton.reset();
+        }
+        return inserted.first->second;
+    }
+
+    size_t size() const { return names.size(); }
+
+    void compile()
+    {
+        if (!automaton)
+            automaton = make_unique<KeywordAutomaton>(names);
+    }
+
+    SkillSet scan(string_view text, pmr::memory_resource *memory = pmr::get_default_resource()) const
+    {
+        if (!automaton)
+            throw logic_error("SkillDictionary::scan called before compile()");
+        pmr::vector<char> seen = automaton->scan(text, memory);
+        SkillSet found;
+        for (uint32_t id = static_cast<uint32_t>(names.size()); id-- > 0;)
+            if (seen[automaton->keywordState(id)])
+                found.insert(id);
+        return found;
+    }
+};
+
+// A job's required skills as dictionary ids. Matching a resume's SkillSet gives the same count and score
+// as SkillMatcher; the found/missing lists are only built when asked for. A skill listed twice (in any
+// case) counts twice, as in SkillMatcher, so such jobs count per listed skill instead of by popcount.
+class SkillJob
+{
+private:
+    vector<string> required_skills;
+    vector<uint32_t> skill_ids;
+    SkillSet required;
+    bool distinct = true;
+
+public:
+    SkillJob(SkillDictionary &dictionary, const vector<string> &skills) : required_skills(skills)
+    {
+        for (const auto &skill : skills)
+        {
+            uint32_t id = dictionary.intern(skill);
+            if (required.contains(id))
+                distinct = false;
+            required.insert(id);
+            skill_ids.push_back(id);
+        }
+    }
+
+    const vector<string> &skills() const { return required_skills; }
+
+    size_t countMatches(const SkillSet &resume) const
+    {
+        if (distinct)
+            return required.intersectionSize(resume);
+        size_t found = 0;
+        for (uint32_t id : skill_ids)
+            found += resume.contains(id);
+        return found;
+    }
+
+    int scoreFor(const SkillSet &resume) const { return skillsScore(countMatches(resume), required_skills.size()); }
+
+    // True if the job's i-th skill is in the resume
+    bool found(const SkillSet &resume, size_t i) const { return resume.contains(skill_ids[i]); }
+
+    // The found and missing lists, identical to SkillMatcher::match on the resume
+    KeywordMatchResult decode(const SkillSet &resume) const
+    {
+        return keywordMatchFor(required_skills, [&](size_t i)
+                               { return found(resume, i); });
+    }
+};
+
+// A keyword of a vocabulary fixed at compile time, and the bits it sets in a match mask
+struct TaggedKeyword
+{
+    string_view text;
+    uint32_t mask;
+};
+
+// Every keyword of words tagged with the same mask
+template <size_t N>
+constexpr array<TaggedKeyword, N> taggedKeywords(const string_view (&words)[N], uint32_t mask)
+{
+    array<TaggedKeyword, N> tagged{};
+    for (size_t i = 0; i < N; i++)
+        tagged[i] = {words[i], mask};
+    return tagged;
+}
+
+// Keyword i of words tagged with bit i
+template <size_t N>
+constexpr array<TaggedKeyword, N> eachKeywordTagged(const string_view (&words)[N])
+{
+    static_assert(N <= 32, "keyword masks hold at most 32 keywords");
+    array<TaggedKeyword, N> tagged{};
+    for (size_t i = 0; i < N; i++)
+        tagged[i] = {words[i], uint32_t(1) << i};
+    return tagged;
+}
+
+template <size_t... N>
+constexpr array<TaggedKeyword, (N + ...)> joinKeywords(const array<TaggedKeyword, N> &...parts)
+{
+    array<TaggedKeyword, (N + ...)> joined{};
+    size_t k = 0;
+    auto append = [&](const auto &part)
+    {
+        for (const auto &keyword : part)
+            joined[k++] = keyword;
+    };
+    (append(parts), ...);
+    return joined;
+}
+
+// Trie states and byte classes needed by a StaticKeywordAutomaton over keywords
+struct AutomatonShape
+{
+    size_t states = 1;
+    size_t alphabet = 1;
+};
+
+template <size_t N>
+constexpr AutomatonShape automatonShape(const array<TaggedKeyword, N> &keywords)
+{
+    AutomatonShape shape;
+    array<bool, 256> seen{};
+    for (size_t i = 0; i < N; i++)
+    {
+        string_view text = keywords[i].text;
+        for (size_t length = 1; length <= text.size(); length++)
+        {
+            // Each distinct prefix is one trie state
+            bool repeated = false;
+            for (size_t j = 0; j < i && !repeated; j++)
+                repeated = keywords[j].text.substr(0, length) == text.substr(0, length);
+            if (!repeated)
+                shape.states++;
+            unsigned char b = static_cast<unsigned char>(text[length - 1]);
+            if (!seen[b])
+            {
+                seen[b] = true;
+                shape.alphabet++;
+            }
+        }
+    }
+    return shape;
+}
+
+// Aho-Corasick automaton built entirely at compile time over lowercase tagged keywords. Each state carries
+// the OR of the masks of all keywords ending there, so matching is one table walk with no branches.
+// ASCII letters are matched case-insensitively like KeywordAutomaton.
+template <size_t States, size_t Alphabet>
+class StaticKeywordAutomaton
+{
+    static_assert(States <= 65536, "state numbers must fit in 16 bits");
+
+private:
+    array<unsigned char, 256> byte_class{};
+    array<uint16_t, States * Alphabet> transitions{}; // state * Alphabet + class -> next state
+    array<uint32_t, States> masks{};
+
+public:
+    template <size_t N>
+    constexpr explicit StaticKeywordAutomaton(const array<TaggedKeyword, N> &keywords)
+    {
+        // Only bytes that occur in a keyword get their own class, everything else shares class 0
+        size_t classes = 1;
+        for (const auto &keyword : keywords)
+            for (char c : keyword.text)
+            {
+                if (c >= 'A' && c <= 'Z')
+                    throw logic_error("static keywords must be lowercase");
+                unsigned char b = static_cast<unsigned char>(c);
+                if (byte_class[b] == 0)
+                    byte_class[b] = static_cast<unsigned char>(classes++);
+            }
+        for (int c = 'A'; c <= 'Z'; c++)
+            byte_class[c] = byte_class[c - 'A' + 'a'];
+
+        // 0 marks a missing trie edge, since no edge leads back to the root
+        size_t state_count = 1;
+        for (const auto &keyword : keywords)
+        {
+            size_t state = 0;
+            for (char c : keyword.text)
+            {
+                size_t slot = state * Alphabet + byte_class[static_cast<unsigned char>(c)];
+                if (transitions[slot] == 0)
+                    transitions[slot] = static_cast<uint16_t>(state_count++);
+                state = transitions[slot];
+            }
+            masks[state] |= keyword.mask;
+        }
+
+        // Breadth-first pass filling failure links, folding their masks in and turning the trie into a DFA
+        array<uint16_t, States> fail{};
+        array<uint16_t, States> pending{};
+        size_t head = 0, tail = 0;
+        pending[tail++] = 0;
+        while (head < tail)
+        {
+            size_t state = pending[head++];
+            for (size_t c = 0; c < Alphabet; c++)
+            {
+                uint16_t &slot = transitions[state * Alphabet + c];
+                uint16_t fallback = state == 0 ? 0 : transitions[fail[state] * Alphabet + c];
+                if (slot == 0)
+                {
+                    slot = fallback;
+                    continue;
+                }
+                fail[slot] = fallback;
+                masks[slot] |= masks[fallback];
+                pending[tail++] = slot;
+            }
+        }
+    }
+
+    // OR of the masks of every keyword occurring anywhere in text
+    constexpr uint32_t matchMask(string_view text) const
+    {
+        uint32_t mask = 0;
+        size_t state = 0;
+        for (char c : text)
+        {
+            state = transitions[state * Alphabet + byte_class[static_cast<unsigned char>(c)]];
+            mask |= masks[state];
+        }
+        return mask;
+    }
+};
+
+// Compile the tagged keyword table Keywords into an automaton sized exactly for it
+template <const auto &Keywords>
+constexpr auto compileKeywords()
+{
+    constexpr AutomatonShape shape = automatonShape(Keywords);
+    return StaticKeywordAutomaton<shape.states, shape.alphabet>(Keywords);
+}
+
+// True if text contains a year from 1900-2099 as a whole word (\b(19|20)\d{2}\b)
+bool containsYear(string_view text)
+{
+    for (size_t i = 0; i + 4 <= text.size(); i++)
+    {
+        if ((text[i] == '1' && text[i + 1] == '9') || (text[i] == '2' && text[i + 1] == '0'))
+            if (isDigitChar(text[i + 2]) && isDigitChar(text[i + 3]) &&
+                isWordBoundary(text, i) && isWordBoundary(text, i + 4))
+                return true;
+    }
+    return false;
+}
+
+// True if text contains a bullet or dash ([•\-\*], which matches any byte of the UTF-8 bullet)
+bool containsBulletMark(string_view text)
+{
+    return text.find_first_of("\xE2\x80\xA2-*") != string_view::npos;
+}
+
+// Call visit(word, end) for every maximal run of word characters until it returns true
+template <typename Visit>
+bool anyWord(string_view text, Visit visit)
+{
+    size_t i = 0;
+    while (i < text.size())
+    {
+        if (!isWordChar(text[i]))
+        {
+            i++;
+            continue;
+        }
+        size_t start = i;
+        while (i < text.size() && isWordChar(text[i]))
+            i++;
+        if (visit(text.substr(start, i - start), i))
+            return true;
+    }
+    return false;
+}
+
+// True if lowercase text contains one of words as a whole word (\b(w1|w2|...)\b)
+bool containsWholeWord(string_view text, initializer_list<string_view> words)
+{
+    return anyWord(text, [&](string_view word, size_t)
+                   { return find(words.begin(), words.end(), word) != words.end(); });
+}
+
+// \b(developed|managed|created|implemented|designed|led|improved)\b on lowercase text
+bool containsActionVerb(string_view text)
+{
+    return containsWholeWord(text, {"developed", "managed", "created", "implemented", "designed", "led", "improved"});
+}
+
+// \b(bachelor|master|phd|b\.|m\.|diploma)\b on lowercase text; "b." only counts when a word follows the dot
+bool containsDegree(string_view text)
+{
+    return anyWord(text, [&](string_view word, size_t end)
+                   {
+                       if (word == "b" || word == "m")
+                           return end + 1 < text.size() && text[end] == '.' && isWordChar(text[end + 1]);
+                       return word == "bachelor" || word == "master" || word == "phd" || word == "diploma"; });
+}
+
+// \b(gpa|cgpa|grade|percentage)\b on lowercase text
+bool containsGpaMention(string_view text)
+{
+    return containsWholeWord(text, {"gpa", "cgpa", "grade", "percentage"});
+}
+
+// Per-thread scratch memory for analyzing one resume. Line tables, section entry views, automaton state
+// sets and the lowercase shadow copy are carved from a buffer that is reset in O(1) when the outermost
+// ScratchScope ends; only the strings copied into the results reach the ordinary heap. The buffer grows
+// to fit the documents seen but never past max_retained; what a larger document needs comes from the heap
+// and is given back as soon as its scope ends.
+class ScratchArena
+{
+private:
+    // Heap chunks the arena had to take after outgrowing its buffer, counted so the buffer can grow
+    class Overflow : public pmr::memory_resource
+    {
+    public:
+        size_t bytes = 0;
+
+    private:
+        void *do_allocate(size_t size, size_t alignment) override
+        {
+            bytes += size;
+            return pmr::new_delete_resource()->allocate(size, alignment);
+        }
+        void do_deallocate(void *p, size_t size, size_t alignment) override
+        {
+            pmr::new_delete_resource()->deallocate(p, size, alignment);
+        }
+        bool do_is_equal(const pmr::memory_resource &other) const noexcept override { return this == &other; }
+    };
+
+    unique_ptr<char[]> buffer;
+    size_t capacity;
+    Overflow overflow;
+    optional<pmr::monotonic_buffer_resource> arena;
+    int depth = 0;
+
+    explicit ScratchArena(size_t initial_capacity) : buffer(new char[initial_capacity]), capacity(initial_capacity)
+    {
+        arena.emplace(buffer.get(), capacity, &overflow);
+    }
+
+    // Forget everything allocated so far. A buffer that overflowed is regrown to the peak it needed, up to
+    // max_retained, so a thread analyzing similar resumes stops touching the heap after the first few
+    void reset()
+    {
+        size_t needed = capacity + overflow.bytes;
+        overflow.bytes = 0;
+        if (needed == capacity || capacity >= max_retained)
+        {
+            arena->release(); // also frees the overflow chunks
+            return;
+        }
+        capacity = min(needed, max_retained);
+        arena.reset();
+        buffer.reset(new char[capacity]);
+        arena.emplace(buffer.get(), capacity, &overflow);
+    }
+
+    friend class ScratchScope;
+
+public:
+    // Largest buffer a thread keeps between documents
+    static constexpr size_t max_retained = 4 << 20;
+
+    static ScratchArena &local()
+    {
+        thread_local ScratchArena scratch(64 << 10);
+        return scratch;
+    }
+
+    pmr::memory_resource *resource() { return &*arena; }
+    size_t bufferSize() const { return capacity; }
+};
+
+// Scratch allocations for one resume; declare it before any container that uses resource(). Scopes
+// nest, and the thread's arena is reset when the outermost one ends.
+class ScratchScope
+{
+private:
+    ScratchArena &scratch;
+
+public:
+    ScratchScope() : scratch(ScratchArena::local()) { scratch.depth++; }
+    ~ScratchScope()
+    {
+        if (--scratch.depth == 0)
+            scratch.reset();
+    }
+    ScratchScope(const ScratchScope &) = delete;
+    ScratchScope &operator=(const ScratchScope &) = delete;
+
+    pmr::memory_resource *resource() const { return scratch.resource(); }
+};
+
+// Stages of the analysis timed by StageClock, in pipeline order
+enum Stage
+{
+    STAGE_NORMALIZE,
+    STAGE_PERSONAL_INFO,
+    STAGE_SEGMENT_SECTIONS,
+    STAGE_SECTION_SCORE,
+    STAGE_FORMATTING,
+    STAGE_ENTRY_CHECKS,
+    STAGE_KEYWORD_MATCH,
+    STAGE_RELEVANCE,
+    STAGE_SUGGESTIONS,
+    STAGE_COUNT
+};
+
+const char *const stage_names[STAGE_COUNT] = {"normalize", "personal_info", "segment_sections", "section_score",
+                                              "formatting", "entry_checks", "keyword_match", "relevance",
+                                              "suggestions"};
+
+// Resume sizes the stage report is broken down by: below 1 KB, below 4 KB, ... and 64 KB or more
+const size_t size_bucket_limits[] = {1 << 10, 4 << 10, 16 << 10, 64 << 10};
+const char *const size_bucket_names[] = {"<1KB", "1-4KB", "4-16KB", "16-64KB", ">=64KB"};
+const size_t SIZE_BUCKETS = size(size_bucket_names);
+
+size_t sizeBucket(size_t bytes)
+{
+    return upper_bound(begin(size_bucket_limits), end(size_bucket_limits), bytes) - begin(size_bucket_limits);
+}
+
+// Log-linear latency histogram in the style of HdrHistogram: values below 32 ns are exact and every
+// power of two above is split into 32 buckets, so quantiles are reported within about 3%.
+// One thread records; any thread may read the counts at the same time.
+class LatencyHistogram
+{
+public:
+    static constexpr int sub_bucket_bits = 5;
+    static constexpr int max_exponent = 40; // about 18 minutes in nanoseconds; longer values share the top bucket
+    static constexpr size_t bucket_count = size_t(max_exponent - sub_bucket_bits + 2) << sub_bucket_bits;
+
+    static size_t bucketOf(uint64_t nanoseconds)
+    {
+        if (nanoseconds < (1u << sub_bucket_bits))
+            return nanoseconds;
+        int exponent = 63 - __builtin_clzll(nanoseconds);
+        if (exponent > max_exponent)
+            return bucket_count - 1;
+        size_t sub_bucket = (nanoseconds >> (exponent - sub_bucket_bits)) & ((1u << sub_bucket_bits) - 1);
+        return (size_t(exponent - sub_bucket_bits + 1) << sub_bucket_bits) + sub_bucket;
+    }
+
+    // Midpoint of the values that fall in bucket
+    static double bucketValue(size_t bucket)
+    {
+        if (bucket < (1u << sub_bucket_bits))
+            return bucket;
+        int shift = int(bucket >> sub_bucket_bits) - 1;
+        uint64_t low = ((1ull << sub_bucket_bits) + (bucket & ((1u << sub_bucket_bits) - 1))) << shift;
+        return low + (1ull << shift) / 2.0;
+    }
+
+    void record(uint64_t nanoseconds)
+    {
+        atomic<uint64_t> &count = counts[bucketOf(nanoseconds)];
+        count.store(count.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    }
+
+    void addTo(vector<uint64_t> &totals) const
+    {
+        for (size_t i = 0; i < bucket_count; i++)
+            totals[i] += counts[i].load(memory_order_relaxed);
+    }
+
+private:
+    array<atomic<uint64_t>, bucket_count> counts{};
+};
+
+// Value below which a fraction q of the samples in a merged histogram fall, in nanoseconds
+double histogramQuantile(const vector<uint64_t> &counts, uint64_t total, double q)
+{
+    uint64_t rank = max<uint64_t>(1, static_cast<uint64_t>(ceil(q * total)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+            return LatencyHistogram::bucketValue(i);
+    }
+    return 0;
+}
+
+// Per-thread stage histograms, one per stage and resume size bucket. Each thread records into its own
+// set without locking; the registry lock is only taken when a thread records for the first time and
+// when a report is made. Sets outlive their threads so pool workers' samples survive shutdown.
+class StageProfiler
+{
+private:
+    using ThreadHistograms = array<LatencyHistogram, STAGE_COUNT * SIZE_BUCKETS>;
+
+    static mutex &registryLock()
+    {
+        static mutex lock;
+        return lock;
+    }
+    static vector<shared_ptr<ThreadHistograms>> &registry()
+    {
+        static vector<shared_ptr<ThreadHistograms>> threads;
+        return threads;
+    }
+
+public:
+    static atomic<bool> &enabled()
+    {
+        static atomic<bool> flag{false};
+        return flag;
+    }
+
+    static ThreadHistograms &local()
+    {
+        thread_local shared_ptr<ThreadHistograms> histograms = []
+        {
+            auto created = make_shared<ThreadHistograms>();
+            lock_guard<mutex> guard(registryLock());
+            registry().push_back(created);
+            return created;
+        }();
+        return *histograms;
+    }
+
+    // All threads' counts merged, indexed [stage * SIZE_BUCKETS + size bucket][histogram bucket]
+    static vector<vector<uint64_t>> snapshot()
+    {
+        vector<vector<uint64_t>> merged(STAGE_COUNT * SIZE_BUCKETS, vector<uint64_t>(LatencyHistogram::bucket_count));
+        lock_guard<mutex> guard(registryLock());
+        for (const auto &thread_histograms : registry())
+            for (size_t i = 0; i < merged.size(); i++)
+                (*thread_histograms)[i].addTo(merged[i]);
+        return merged;
+    }
+
+    // p50/p99/p999 in microseconds per stage, for every size bucket with samples and for all sizes together
+    static string report(bool json)
+    {
+        vector<vector<uint64_t>> merged = snapshot();
+        string out = json ? "{\"unit\":\"us\",\"stages\":[" : "";
+        char line[160];
+        if (!json)
+        {
+            snprintf(line, sizeof(line), "%-17s %-8s %10s %10s %10s %10s\n", "stage", "size", "count", "p50_us",
+                     "p99_us", "p999_us");
+            out += line;
+        }
+        bool first = true;
+        for (size_t stage = 0; stage < STAGE_COUNT; stage++)
+        {
+            vector<uint64_t> all(LatencyHistogram::bucket_count);
+            for (size_t bucket = 0; bucket <= SIZE_BUCKETS; bucket++)
+            {
+                const vector<uint64_t> &counts = bucket < SIZE_BUCKETS ? merged[stage * SIZE_BUCKETS + bucket] : all;
+                if (bucket < SIZE_BUCKETS)
+                    for (size_t i = 0; i < counts.size(); i++)
+                        all[i] += counts[i];
+                uint64_t total = 0;
+                for (uint64_t count : counts)
+                    total += count;
+                if (total == 0)
+                    continue;
+                const char *size_name = bucket < SIZE_BUCKETS ? size_bucket_names[bucket] : "all";
+                double p50 = histogramQuantile(counts, total, 0.5) / 1e3;
+                double p99 = histogramQuantile(counts, total, 0.99) / 1e3;
+                double p999 = histogramQuantile(counts, total, 0.999) / 1e3;
+                if (json)
+                    snprintf(line, sizeof(line),
+                             "%s{\"stage\":\"%s\",\"size\":\"%s\",\"count\":%llu,\"p50\":%.3f,\"p99\":%.3f,\"p999\":%.3f}",
+                             first ? "" : ",", stage_names[stage], size_name, static_cast<unsigned long long>(total),
+                             p50, p99, p999);
+                else
+                    snprintf(line, sizeof(line), "%-17s %-8s %10llu %10.3f %10.3f %10.3f\n", stage_names[stage],
+                             size_name, static_cast<unsigned long long>(total), p50, p99, p999);
+                out += line;
+                first = false;
+            }
+        }
+        if (json)
+            out += "]}\n";
+        return out;
+    }
+};
+
+// Times consecutive stages of one resume's analysis: each lap() records the time since the previous lap
+// (or construction) under the given stage. Costs one relaxed load unless StageProfiler::enabled() is set,
+// and compiles to nothing with -DATS_NO_STAGE_TIMERS.
+class StageClock
+{
+#ifndef ATS_NO_STAGE_TIMERS
+private:
+    LatencyHistogram *histograms = nullptr;
+    chrono::steady_clock::time_point last;
+
+public:
+    explicit StageClock(size_t resume_bytes)
+    {
+        if (!StageProfiler::enabled().load(memory_order_relaxed))
+            return;
+        histograms = &StageProfiler::local()[0] + sizeBucket(resume_bytes);
+        last = chrono::steady_clock::now();
+    }
+
+    void lap(Stage stage)
+    {
+        if (!histograms)
+            return;
+        auto now = chrono::steady_clock::now();
+        histograms[stage * SIZE_BUCKETS].record(chrono::duration_cast<chrono::nanoseconds>(now - last).count());
+        last = now;
+    }
+#else
+public:
+    explicit StageClock(size_t) {}
+    void lap(Stage) {}
+#endif
+};
+
+// Resume text plus a lowercase shadow copy and a line table, built once so the analysis can work on views
+class ResumeText
+{
+private:
+    string_view raw;
+    pmr::string lower;
+    pmr::vector<string_view> line_views;
+
+public:
+    // The caller keeps text alive for as long as this object and any views taken from it are used
+    explicit ResumeText(string_view text, pmr::memory_resource *memory = pmr::get_default_resource())
+        : raw(text), lower(text.size(), '\0', memory), line_views(split(text, '\n', memory))
+    {
+        textKernels().to_lower(text.data(), lower.data(), text.size());
+    }
+
+    string_view text() const { return raw; }
+    string_view lowerText() const { return lower; }
+    const pmr::vector<string_view> &lines() const { return line_views; }
+
+    // The lowercase counterpart of a view into text()
+    string_view lowered(string_view slice) const
+    {
+        return string_view(lower).substr(slice.data() - raw.data(), slice.size());
+    }
+};
+
+// Entries of one resume section as views into the text; entry k is parts[entry_ends[k - 1], entry_ends[k])
+struct SectionEntries
+{
+    pmr::vector<string_view> parts;
+    pmr::vector<size_t> entry_ends;
+
+    explicit SectionEntries(pmr::memory_resource *memory) : parts(memory), entry_ends(memory) {}
+
+    bool empty() const { return entry_ends.empty(); }
+
+    // Each entry's lines joined the way the extractors always reported them: every part followed by a space
+    vector<string> materialize() const
+    {
+        vector<string> entries;
+        entries.reserve(entry_ends.size());
+        size_t begin = 0;
+        for (size_t end : entry_ends)
+        {
+            size_t length = 0;
+            for (size_t i = begin; i < end; i++)
+                length += parts[i].size() + 1;
+            string joined;
+            joined.reserve(length);
+            for (size_t i = begin; i < end; i++)
+            {
+                joined.append(parts[i]);
+                joined.push_back(' ');
+            }
+            entries.push_back(move(joined));
+            begin = end;
+        }
+        return entries;
+    }
+};
+
+// Education, experience and project entries as views into the resume text
+struct SectionViews
+{
+    SectionEntries education;
+    SectionEntries experience;
+    SectionEntries projects;
+
+    explicit SectionViews(pmr::memory_resource *memory = pmr::get_default_resource())
+        : education(memory), experience(memory), projects(memory) {}
+};
+
+// Problems found by the formatting check, in the order their messages are reported
+enum FormatIssue : unsigned
+{
+    RESUME_TOO_SHORT = 1,
+    NO_SECTION_HEADERS = 2,
+    NO_BULLET_POINTS = 4,
+    INCONSISTENT_SPACING = 8,
+    MISSING_CONTACT = 16
+};
+
+// Formatting score and the set of FormatIssue bits that were deducted
+struct FormatCheck
+{
+    int score;
+    unsigned issues;
+};
+
+// The job-independent part of a resume analysis, reusable for every job the resume is scored against
+struct DocumentAnalysis
+{
+    PersonalInfo personal_info;
+    vector<string> education;
+    vector<string> experience;
+    vector<string> projects;
+    int section_score = 0;
+    FormatCheck format{100, 0};
+    bool experience_has_dates = false;
+    bool experience_has_bullets = false;
+    bool experience_has_action_verbs = false;
+    bool education_has_dates = false;
+    bool education_has_degree = false;
+    bool education_has_gpa = false;
+};
+
+// What the ATS score and the suggestions take from a resume's job-independent analysis: no strings, only
+// whether each contact detail and section is present, the entry checks and the section and format scores
+struct DocumentScores
+{
+    bool has_email = false;
+    bool has_phone = false;
+    bool has_linkedin = false;
+    bool has_education = false;
+    bool has_experience = false;
+    bool experience_has_dates = false;
+    bool experience_has_bullets = false;
+    bool experience_has_action_verbs = false;
+    bool education_has_dates = false;
+    bool education_has_degree = false;
+    bool education_has_gpa = false;
+    int section_score = 0;
+    FormatCheck format{100, 0};
+};
+
+// Fast 64-bit hash of a resume's bytes, used to recognize resubmitted resumes; other seeds give
+// independent hashes
+uint64_t contentHash(string_view text, uint64_t seed = 0xA0761D6478BD642Full)
+{
+    const uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    uint64_t hash = seed ^ (text.size() * multiplier);
+    auto mix = [&](uint64_t block)
+    {
+        block *= 0xBF58476D1CE4E5B9ull;
+        block ^= block >> 31;
+        hash = (hash ^ block) * multiplier;
+        hash ^= hash >> 29;
+    };
+    size_t i = 0;
+    for (; i + 8 <= text.size(); i += 8)
+    {
+        uint64_t block;
+        memcpy(&block, text.data() + i, 8);
+        mix(block);
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, text.data() + i, text.size() - i);
+    mix(tail ^ 0xFF);
+    hash ^= hash >> 32;
+    hash *= 0xD6E8FEB86659FD93ull;
+    return hash ^ (hash >> 32);
+}
+
+// What caches key a resume's analysis by instead of its text: its length and two independently seeded
+// content hashes, so that handing back another resume's analysis takes a collision of both
+struct ContentKey
+{
+    uint64_t hash = 0;
+    uint64_t check = 0;
+    uint64_t length = 0;
+
+    static ContentKey of(string_view text)
+    {
+        return {contentHash(text), contentHash(text, 0xE7037ED1A0B428DBull), text.size()};
+    }
+
+    bool operator==(const ContentKey &other) const
+    {
+        return hash == other.hash && check == other.check && length == other.length;
+    }
+};
+
+struct ContentKeyHash
+{
+    size_t operator()(const ContentKey &key) const { return key.hash ^ (key.length * 0x9E3779B97F4A7C15ull); }
+};
+
+// Append value to out in a fixed little-endian layout (the spill files are host-local)
+template <typename T>
+void appendRaw(string &out, const T &value)
+{
+    out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readRaw(string_view &in, T &value)
+{
+    if (in.size() < sizeof(T))
+        return false;
+    memcpy(&value, in.data(), sizeof(T));
+    in.remove_prefix(sizeof(T));
+    return true;
+}
+
+void appendLengthPrefixed(string &out, string_view s)
+{
+    appendRaw(out, static_cast<uint32_t>(s.size()));
+    out.append(s);
+}
+
+bool readLengthPrefixed(string_view &in, string &s)
+{
+    uint32_t length;
+    if (!readRaw(in, length) || in.size() < length)
+        return false;
+    s.assign(in.data(), length);
+    in.remove_prefix(length);
+    return true;
+}
+
+// Serialize a DocumentAnalysis for the cache's spill directory
+string serializeAnalysis(const DocumentAnalysis &analysis)
+{
+    string out;
+    for (const string *field : {&analysis.personal_info.name, &analysis.personal_info.email, &analysis.personal_info.phone,
+                                &analysis.personal_info.linkedin, &analysis.personal_info.github,
+                                &analysis.personal_info.codeforces})
+        appendLengthPrefixed(out, *field);
+    for (const vector<string> *section : {&analysis.education, &analysis.experience, &analysis.projects})
+    {
+        appendRaw(out, static_cast<uint32_t>(section->size()));
+        for (const auto &entry : *section)
+            appendLengthPrefixed(out, entry);
+    }
+    appendRaw(out, static_cast<int32_t>(analysis.section_score));
+    appendRaw(out, static_cast<int32_t>(analysis.format.score));
+    appendRaw(out, static_cast<uint32_t>(analysis.format.issues));
+    uint8_t flags = analysis.experience_has_dates | analysis.experience_has_bullets << 1 |
+                    analysis.experience_has_action_verbs << 2 | analysis.education_has_dates << 3 |
+                    analysis.education_has_degree << 4 | analysis.education_has_gpa << 5;
+    appendRaw(out, flags);
+    return out;
+}
+
+bool deserializeAnalysis(string_view in, DocumentAnalysis &analysis)
+{
+    for (string *field : {&analysis.personal_info.name, &analysis.personal_info.email, &analysis.personal_info.phone,
+                          &analysis.personal_info.linkedin, &analysis.personal_info.github,
+                          &analysis.personal_info.codeforces})
+        if (!readLengthPrefixed(in, *field))
+            return false;
+    for (vector<string> *section : {&analysis.education, &analysis.experience, &analysis.projects})
+    {
+        uint32_t count;
+        if (!readRaw(in, count) || count > in.size())
+            return false;
+        section->resize(count);
+        for (auto &entry : *section)
+            if (!readLengthPrefixed(in, entry))
+                return false;
+    }
+    int32_t section_score, format_score;
+    uint32_t issues;
+    uint8_t flags;
+    if (!readRaw(in, section_score) || !readRaw(in, format_score) || !readRaw(in, issues) || !readRaw(in, flags) ||
+        !in.empty())
+        return false;
+    analysis.section_score = section_score;
+    analysis.format = FormatCheck{format_score, issues};
+    analysis.experience_has_dates = flags & 1;
+    analysis.experience_has_bullets = flags & 2;
+    analysis.experience_has_action_verbs = flags & 4;
+    analysis.education_has_dates = flags & 8;
+    analysis.education_has_degree = flags & 16;
+    analysis.education_has_gpa = flags & 32;
+    return true;
+}
+
+// Bounded LRU cache of job-independent analyses keyed by the ContentKey of the resume text.
+// Evicted entries are written to spill_directory when one is given and read back (and their file
+// removed) on a later miss. Safe to share between threads.
+class AnalysisCache
+{
+public:
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t disk_hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t spill_failures = 0; // evicted entries that could not be written out, and were dropped
+    };
+
+private:
+    using Key = ContentKey;
+    using Entry = pair<Key, shared_ptr<const DocumentAnalysis>>;
+
+    size_t capacity;
+    string spill_directory;
+    list<Entry> recency; // most recently used first
+    unordered_map<Key, list<Entry>::iterator, ContentKeyHash> entries;
+    unordered_set<Key, ContentKeyHash> spilled; // keys with a spill file
+    mutable mutex lock;
+    Stats counters;
+
+    string spillPath(const Key &key) const
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "%016llx-%016llx-%llu.bin", static_cast<unsigned long long>(key.hash),
+                 static_cast<unsigned long long>(key.check), static_cast<unsigned long long>(key.length));
+        return (filesystem::path(spill_directory) / name).string();
+    }
+
+    // Remove the spill file of key, if any, once it is read back or superseded; called under lock
+    void dropSpillLocked(const Key &key)
+    {
+        if (spilled.erase(key))
+        {
+            error_code ignored;
+            filesystem::remove(spillPath(key), ignored);
+        }
+    }
+
+    // Add an entry under lock and return the entries pushed out of memory
+    vector<Entry> insertLocked(const Key &key, shared_ptr<const DocumentAnalysis> analysis)
+    {
+        vector<Entry> evicted;
+        auto it = entries.find(key);
+        if (it != entries.end())
+        {
+            recency.splice(recency.begin(), recency, it->second);
+            return evicted;
+        }
+        dropSpillLocked(key);
+        recency.emplace_front(key, move(analysis));
+        entries[key] = recency.begin();
+        while (entries.size() > capacity)
+        {
+            evicted.push_back(move(recency.back()));
+            entries.erase(recency.back().first);
+            recency.pop_back();
+            counters.evictions++;
+        }
+        return evicted;
+    }
+
+    void spill(const vector<Entry> &evicted)
+    {
+        if (spill_directory.empty())
+            return;
+        for (const auto &entry : evicted)
+        {
+            string path = spillPath(entry.first), data = serializeAnalysis(*entry.second);
+            ofstream out(path, ios::binary | ios::trunc);
+            out.write(data.data(), data.size());
+            out.close();
+            lock_guard<mutex> guard(lock);
+            if (out)
+                spilled.insert(entry.first);
+            else
+            {
+                // A partial file would only be rejected when read back, so drop it now
+                error_code ignored;
+                filesystem::remove(path, ignored);
+                counters.spill_failures++;
+            }
+        }
+    }
+
+public:
+    // Spill files left in spill_dir by an earlier run are read back like this run's own
+    explicit AnalysisCache(size_t max_entries, string spill_dir = "")
+        : capacity(max(size_t(1), max_entries)), spill_directory(move(spill_dir))
+    {
+        if (spill_directory.empty())
+            return;
+        filesystem::create_directories(spill_directory);
+        for (const auto &file : filesystem::directory_iterator(spill_directory))
+        {
+            unsigned long long hash, check, length;
+            char extension[8];
+            if (sscanf(file.path().filename().c_str(), "%16llx-%16llx-%llu.%3s", &hash, &check, &length, extension) == 4 &&
+                string(extension) == "bin")
+                spilled.insert(Key{hash, check, length});
+        }
+    }
+
+    // The cached analysis of a text with this key, or null
+    shared_ptr<const DocumentAnalysis> find(const Key &key)
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            auto it = entries.find(key);
+            if (it != entries.end())
+            {
+                recency.splice(recency.begin(), recency, it->second);
+                counters.hits++;
+                return it->second->second;
+            }
+            if (!spilled.count(key))
+            {
+                counters.misses++;
+                return nullptr;
+            }
+        }
+        shared_ptr<const DocumentAnalysis> loaded;
+        ifstream in(spillPath(key), ios::binary);
+        if (in)
+        {
+            string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+            DocumentAnalysis analysis;
+            if (deserializeAnalysis(data, analysis))
+                loaded = make_shared<const DocumentAnalysis>(move(analysis));
+        }
+        vector<Entry> evicted;
+        {
+            lock_guard<mutex> guard(lock);
+            if (!loaded)
+            {
+                // Unreadable: it would never be read back either
+                dropSpillLocked(key);
+                counters.misses++;
+                return nullptr;
+            }
+            counters.disk_hits++;
+            evicted = insertLocked(key, loaded);
+        }
+        spill(evicted);
+        return loaded;
+    }
+
+    void insert(const Key &key, shared_ptr<const DocumentAnalysis> analysis)
+    {
+        vector<Entry> evicted;
+        {
+            lock_guard<mutex> guard(lock);
+            evicted = insertLocked(key, move(analysis));
+        }
+        spill(evicted);
+    }
+
+    Stats stats() const
+    {
+        lock_guard<mutex> guard(lock);
+        return counters;
+    }
+};
+
+// Finds near-duplicate resumes (template clones, lightly edited resubmissions) so they can share the
+// job-independent analysis of the first such resume seen, their cluster's representative. A resume is
+// reduced to a one-permutation MinHash signature over 3-word shingles of its lowercased,
+// whitespace-collapsed text: each shingle is hashed once, the hash picks a bin and the bin keeps its
+// smallest value, and empty bins borrow from the next filled one. LSH buckets each representative by
+// bands of the signature, so a lookup only compares against the representatives sharing a band, a
+// bounded number per bucket, however many resumes have been indexed.
+// Representatives live in a ring of capacity slots, so memory stays bounded on unbounded streams: a new
+// representative evicts the oldest one. A representative matched while in the older half of the ring
+// is moved to the front, so a cluster that keeps getting resumes stays indexed. Bucket walks stop after
+// max_bucket_walk representatives, newest first; in a bucket crowded by one popular template, an older
+// representative past that point is not found, and truncated_walks counts how often that can happen.
+class NearDuplicateIndex
+{
+public:
+    static constexpr size_t bands = 16;
+    static constexpr size_t rows = 4;
+    static constexpr size_t hash_count = bands * rows;
+    // 16-bit minimums are plenty to estimate similarity and halve the index
+    using Signature = array<uint16_t, hash_count>;
+
+    static constexpr size_t default_capacity = 10000;
+    static constexpr size_t max_bucket_walk = 32;
+
+    struct Stats
+    {
+        size_t representatives = 0; // currently indexed
+        size_t reused = 0;
+        size_t comparisons = 0;
+        size_t evicted = 0;
+        size_t truncated_walks = 0; // bucket walks stopped at max_bucket_walk with older representatives left
+    };
+
+private:
+    static constexpr uint64_t end_of_bucket = UINT64_MAX;
+
+    // Representatives are numbered in insertion order; number id sits in slot id % capacity until
+    // number id + capacity replaces it
+    struct Representative
+    {
+        uint64_t id = end_of_bucket;
+        Signature signature;
+        shared_ptr<const DocumentAnalysis> analysis; // null once moved to the front of the ring
+        array<uint64_t, bands> next;                 // the next older representative in each band's bucket
+    };
+
+    double min_similarity;
+    size_t capacity;
+    vector<Representative> slots;
+    uint64_t next_id = 0;
+    unordered_map<uint64_t, uint64_t> bucket_heads; // band key -> newest representative in that bucket
+    mutable mutex lock;
+    Stats counters;
+
+    // The representative numbered id if it is still in the ring (moved or not), else null
+    const Representative *slotOf(uint64_t id) const
+    {
+        if (id == end_of_bucket || id + capacity < next_id || slots[id % capacity].id != id)
+            return nullptr;
+        return &slots[id % capacity];
+    }
+
+    void insertLocked(const Signature &signature, shared_ptr<const DocumentAnalysis> analysis)
+    {
+        uint64_t id = next_id++;
+        if (slots.size() < capacity)
+            slots.emplace_back();
+        Representative &slot = slots[id % capacity];
+        if (slot.id != end_of_bucket)
+        {
+            // Evict the oldest representative; it is the last of every bucket it is in
+            for (size_t band = 0; band < bands; band++)
+            {
+                auto head = bucket_heads.find(bandKey(slot.signature, band));
+                if (head != bucket_heads.end() && head->second == slot.id)
+                    bucket_heads.erase(head);
+            }
+            if (slot.analysis)
+            {
+                counters.representatives--;
+                counters.evicted++;
+            }
+        }
+        slot.id = id;
+        slot.signature = signature;
+        slot.analysis = move(analysis);
+        for (size_t band = 0; band < bands; band++)
+        {
+            auto [head, inserted] = bucket_heads.try_emplace(bandKey(signature, band), id);
+            slot.next[band] = inserted ? end_of_bucket : head->second;
+            head->second = id;
+        }
+        counters.representatives++;
+    }
+
+    static uint64_t bandKey(const Signature &signature, size_t band)
+    {
+        uint64_t key = band * 0x9E3779B97F4A7C15ull;
+        for (size_t r = 0; r < rows; r++)
+            key = (key ^ signature[band * rows + r]) * 0xBF58476D1CE4E5B9ull;
+        return key ^ (key >> 31);
+    }
+
+public:
+    // min_similarity is the estimated Jaccard similarity of shingle sets above which resumes count as
+    // duplicates; at most max_representatives analyses are kept
+    explicit NearDuplicateIndex(double similarity = 0.8, size_t max_representatives = default_capacity)
+        : min_similarity(similarity), capacity(max(max_representatives, size_t(1)))
+    {
+    }
+
+    // MinHash signature of text, or nullopt when it has no words to compare
+    static optional<Signature> signatureOf(string_view text)
+    {
+        ScratchScope scratch;
+        pmr::string lower(text.size(), '\0', scratch.resource());
+        textKernels().to_lower(text.data(), lower.data(), text.size());
+        static_assert(hash_count == 64, "bins are picked by the top 6 bits of a shingle hash");
+        Signature signature;
+        signature.fill(UINT16_MAX);
+        uint64_t filled = 0;
+        uint64_t words[3] = {};
+        size_t word_count = 0, i = 0;
+        auto addShingle = [&]()
+        {
+            uint64_t hash = words[0] ^ (words[1] * 0x9E3779B97F4A7C15ull) ^ (words[2] * 0xBF58476D1CE4E5B9ull);
+            hash = (hash ^ (hash >> 31)) * 0x94D049BB133111EBull;
+            hash ^= hash >> 29;
+            size_t bin = hash >> 58;
+            signature[bin] = min(signature[bin], static_cast<uint16_t>(hash));
+            filled |= uint64_t(1) << bin;
+        };
+        while (i < lower.size())
+        {
+            if (isSpaceChar(lower[i]))
+            {
+                i++;
+                continue;
+            }
+            // FNV-1a over the word's bytes
+            uint64_t word = 0xCBF29CE484222325ull;
+            while (i < lower.size() && !isSpaceChar(lower[i]))
+                word = (word ^ static_cast<unsigned char>(lower[i++])) * 0x100000001B3ull;
+            words[0] = words[1];
+            words[1] = words[2];
+            words[2] = word;
+            if (++word_count >= 3)
+                addShingle();
+        }
+        if (word_count == 0)
+            return nullopt;
+        // A text of one or two words is a single shingle
+        if (word_count < 3)
+            addShingle();
+        // Densify: an empty bin takes the value of the next filled bin, wrapping around
+        for (size_t bin = 0; bin < hash_count; bin++)
+        {
+            size_t from = bin;
+            while (!((filled >> from) & 1))
+                from = (from + 1) % hash_count;
+            signature[bin] = signature[from];
+        }
+        return signature;
+    }
+
+    static double similarity(const Signature &a, const Signature &b)
+    {
+        size_t equal = 0;
+        for (size_t h = 0; h < hash_count; h++)
+            equal += a[h] == b[h];
+        return static_cast<double>(equal) / hash_count;
+    }
+
+    // The analysis of the most similar representative at or above the similarity threshold, or null
+    shared_ptr<const DocumentAnalysis> find(const Signature &signature)
+    {
+        lock_guard<mutex> guard(lock);
+        uint64_t best = end_of_bucket;
+        double best_similarity = min_similarity;
+        for (size_t band = 0; band < bands; band++)
+        {
+            auto head = bucket_heads.find(bandKey(signature, band));
+            if (head == bucket_heads.end())
+                continue;
+            size_t walked = 0;
+            const Representative *slot = slotOf(head->second);
+            for (; slot && walked < max_bucket_walk; slot = slotOf(slot->next[band]))
+            {
+                if (!slot->analysis)
+                    continue;
+                walked++;
+                counters.comparisons++;
+                double estimate = similarity(signature, slot->signature);
+                if (estimate >= best_similarity)
+                {
+                    best = slot->id;
+                    best_similarity = estimate;
+                }
+            }
+            if (slot)
+                counters.truncated_walks++;
+        }
+        if (best == end_of_bucket)
+            return nullptr;
+        counters.reused++;
+        Representative &found = slots[best % capacity];
+        shared_ptr<const DocumentAnalysis> analysis = found.analysis;
+        if (best + capacity / 2 < next_id)
+        {
+            // Still in use: move it to the front of the ring, leaving the old slot to be overwritten
+            Signature moved = found.signature;
+            found.analysis = nullptr;
+            counters.representatives--;
+            insertLocked(moved, analysis);
+        }
+        return analysis;
+    }
+
+    // Make a resume with this signature the representative of a new cluster
+    void insert(const Signature &signature, shared_ptr<const DocumentAnalysis> analysis)
+    {
+        lock_guard<mutex> guard(lock);
+        insertLocked(signature, move(analysis));
+    }
+
+    Stats stats() const
+    {
+        lock_guard<mutex> guard(lock);
+        return counters;
+    }
+};
+
+// Thread pool where every worker owns a deque of tasks; a worker runs its own tasks newest first
+// and, when it runs out, steals the oldest task from another worker
+class WorkStealingPool
+{
+private:
+    struct Worker
+    {
+        mutex lock;
+        deque<function<void()>> tasks;
+    };
+
+    vector<unique_ptr<Worker>> workers;
+    vector<thread> threads;
+    mutex idle_lock;
+    condition_variable wake;
+    size_t queued = 0; // tasks sitting in any deque, guarded by idle_lock
+    bool stopping = false;
+    atomic<size_t> next_worker{0};
+
+    bool takeTask(size_t self, function<void()> &task)
+    {
+        for (size_t k = 0; k < workers.size(); k++)
+        {
+            Worker &victim = *workers[(self + k) % workers.size()];
+            lock_guard<mutex> guard(victim.lock);
+            if (victim.tasks.empty())
+                continue;
+            if (k == 0)
+            {
+                task = move(victim.tasks.back());
+                victim.tasks.pop_back();
+            }
+            else
+            {
+                task = move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+            lock_guard<mutex> idle(idle_lock);
+            queued--;
+            return true;
+        }
+        return false;
+    }
+
+    void run(size_t self)
+    {
+        function<void()> task;
+        while (true)
+        {
+            if (takeTask(self, task))
+            {
+                task();
+                continue;
+            }
+            unique_lock<mutex> idle(idle_lock);
+            wake.wait(idle, [&]
+                      { return stopping || queued > 0; });
+            if (stopping && queued == 0)
+                return;
+        }
+    }
+
+public:
+    explicit WorkStealingPool(size_t thread_count = thread::hardware_concurrency())
+    {
+        thread_count = max<size_t>(1, thread_count);
+        for (size_t i = 0; i < thread_count; i++)
+            workers.push_back(make_unique<Worker>());
+        for (size_t i = 0; i < thread_count; i++)
+            threads.emplace_back([this, i]
+                                 { run(i); });
+    }
+
+    ~WorkStealingPool()
+    {
+        {
+            lock_guard<mutex> idle(idle_lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto &t : threads)
+            t.join();
+    }
+
+    size_t size() const { return threads.size(); }
+
+    // Queue a task on the next worker in round-robin order
+    void submit(function<void()> task)
+    {
+        Worker &worker = *workers[next_worker++ % workers.size()];
+        {
+            lock_guard<mutex> guard(worker.lock);
+            worker.tasks.push_back(move(task));
+        }
+        {
+            lock_guard<mutex> idle(idle_lock);
+            queued++;
+        }
+        wake.notify_one();
+    }
+
+    // Run body(begin, end) over chunks of [0, count) on the workers and wait for all of them;
+    // the first exception thrown by a chunk is rethrown here
+    void parallelFor(size_t count, const function<void(size_t, size_t)> &body)
+    {
+        if (count == 0)
+            return;
+        size_t chunks = min(count, threads.size() * 8);
+        mutex done_lock;
+        condition_variable done;
+        size_t remaining = chunks;
+        exception_ptr error;
+        for (size_t c = 0; c < chunks; c++)
+        {
+            size_t begin = count * c / chunks, end = count * (c + 1) / chunks;
+            submit([&, begin, end]
+                   {
+                       exception_ptr chunk_error;
+                       try
+                       {
+                           body(begin, end);
+                       }
+                       catch (...)
+                       {
+                           chunk_error = current_exception();
+                       }
+                       lock_guard<mutex> guard(done_lock);
+                       if (chunk_error && !error)
+                           error = chunk_error;
+                       if (--remaining == 0)
+                           done.notify_one(); });
+        }
+        unique_lock<mutex> guard(done_lock);
+        done.wait(guard, [&]
+                  { return remaining == 0; });
+        if (error)
+            rethrow_exception(error);
+    }
+};
+
+// Bounded multi-producer multi-consumer queue on a ring of cells that carry sequence numbers (Vyukov's
+// design): tryPush and tryPop take no lock. push and pop park the thread on a condition variable only
+// while the queue is full or empty, so a slow consumer holds its producers back instead of letting the
+// queue grow. close() ends the stream: pop drains what is left and then returns false.
+template <typename T>
+class BoundedQueue
+{
+private:
+    struct alignas(64) Cell
+    {
+        atomic<size_t> sequence;
+        T value;
+    };
+
+    unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(64) atomic<size_t> enqueue_position{0};
+    alignas(64) atomic<size_t> dequeue_position{0};
+    atomic<bool> closed{false};
+    atomic<size_t> waiting_producers{0};
+    atomic<size_t> waiting_consumers{0};
+    mutex park_lock;
+    condition_variable not_full;
+    condition_variable not_empty;
+    // Depth seen by each push, for the report
+    atomic<uint64_t> pushes{0};
+    atomic<uint64_t> depth_total{0};
+    atomic<size_t> depth_max{0};
+    atomic<uint64_t> full_pushes{0};
+
+    // Wake a thread parked on condition if any is; the fence orders the queue update before the check,
+    // pairing with the one a parking thread makes between registering and retrying
+    void wake(atomic<size_t> &waiting, condition_variable &condition)
+    {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (waiting.load(memory_order_relaxed) > 0)
+        {
+            lock_guard<mutex> guard(park_lock);
+            condition.notify_one();
+        }
+    }
+
+public:
+    // Capacity is rounded up to a power of two
+    explicit BoundedQueue(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity)
+            size *= 2;
+        cells.reset(new Cell[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++)
+            cells[i].sequence.store(i, memory_order_relaxed);
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+    bool tryPush(T &value)
+    {
+        size_t position = enqueue_position.load(memory_order_relaxed);
+        while (true)
+        {
+            Cell &cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (difference == 0)
+            {
+                if (enqueue_position.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+                {
+                    cell.value = move(value);
+                    cell.sequence.store(position + 1, memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+                return false; // full
+            else
+                position = enqueue_position.load(memory_order_relaxed);
+        }
+    }
+
+    bool tryPop(T &value)
+    {
+        size_t position = dequeue_position.load(memory_order_relaxed);
+        while (true)
+        {
+            Cell &cell = cells[position & mask];
+            size_t sequence = cell.sequence.load(memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if (difference == 0)
+            {
+                if (dequeue_position.compare_exchange_weak(position, position + 1, memory_order_relaxed))
+                {
+                    value = move(cell.value);
+                    cell.sequence.store(position + mask + 1, memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+                return false; // empty
+            else
+                position = dequeue_position.load(memory_order_relaxed);
+        }
+    }
+
+    // Push value, waiting while the queue is full
+    void push(T value)
+    {
+        if (!tryPush(value))
+        {
+            full_pushes.fetch_add(1, memory_order_relaxed);
+            unique_lock<mutex> guard(park_lock);
+            waiting_producers.fetch_add(1);
+            atomic_thread_fence(memory_order_seq_cst);
+            while (!tryPush(value))
+                not_full.wait(guard);
+            waiting_producers.fetch_sub(1);
+        }
+        size_t depth = enqueue_position.load(memory_order_relaxed) - dequeue_position.load(memory_order_relaxed);
+        depth = min(depth, capacity());
+        pushes.fetch_add(1, memory_order_relaxed);
+        depth_total.fetch_add(depth, memory_order_relaxed);
+        size_t seen = depth_max.load(memory_order_relaxed);
+        while (depth > seen && !depth_max.compare_exchange_weak(seen, depth, memory_order_relaxed))
+        {
+        }
+        wake(waiting_consumers, not_empty);
+    }
+
+    // Pop into value, waiting while the queue is empty; false once it is closed and drained
+    bool pop(T &value)
+    {
+        if (!tryPop(value))
+        {
+            unique_lock<mutex> guard(park_lock);
+            waiting_consumers.fetch_add(1);
+            atomic_thread_fence(memory_order_seq_cst);
+            while (true)
+            {
+                // Every push happened before close(), so nothing can arrive after this check fails
+                bool was_closed = closed.load(memory_order_acquire);
+                if (tryPop(value))
+                    break;
+                if (was_closed)
+                {
+                    waiting_consumers.fetch_sub(1);
+                    return false;
+                }
+                not_empty.wait(guard);
+            }
+            waiting_consumers.fetch_sub(1);
+        }
+        wake(waiting_producers, not_full);
+        return true;
+    }
+
+    // No more pushes will come
+    void close()
+    {
+        closed.store(true, memory_order_release);
+        lock_guard<mutex> guard(park_lock);
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+    struct Stats
+    {
+        uint64_t pushes;
+        double mean_depth;
+        size_t max_depth;
+        uint64_t full_pushes; // pushes that had to wait for room
+    };
+
+    Stats stats() const
+    {
+        uint64_t count = pushes.load();
+        return {count, count ? static_cast<double>(depth_total.load()) / count : 0.0, depth_max.load(),
+                full_pushes.load()};
+    }
+};
+
+// Section header vocabularies, all lowercase
+constexpr string_view section_header_keywords[] = {"experience", "education", "skills", "work", "project", "objective",
+                                                   "summary", "employment", "qualification", "achievements"};
+constexpr string_view education_keywords[] = {
+    "education", "academic", "qualification", "degree", "university", "college", "school", "institute",
+    "certification", "diploma", "bachelor", "master", "phd", "b.tech", "m.tech", "b.e", "m.e", "b.sc", "m.sc",
+    "bca", "mca", "b.com", "m.com", "b.cs-it", "imca", "bba", "mba", "honors", "scholarship"};
+constexpr string_view experience_keywords[] = {
+    "experience", "employment", "work history", "professional experience", "work experience", "career history",
+    "professional background", "employment history", "job history", "positions held", "job title",
+    "job responsibilities", "job description", "job summary"};
+constexpr string_view project_keywords[] = {
+    "projects", "personal projects", "academic projects", "key projects", "major projects",
+    "professional projects", "project experience", "relevant projects", "featured projects", "latest projects",
+    "top projects"};
+
+// Bits a line's section mask gets for each vocabulary
+enum SectionMask : unsigned char
+{
+    EDUCATION_HEADER = 1,
+    EXPERIENCE_HEADER = 2,
+    PROJECT_HEADER = 4,
+    ANY_SECTION = 8
+};
+
+constexpr auto section_vocabulary = joinKeywords(
+    taggedKeywords(education_keywords, EDUCATION_HEADER), taggedKeywords(experience_keywords, EXPERIENCE_HEADER),
+    taggedKeywords(project_keywords, PROJECT_HEADER), taggedKeywords(section_header_keywords, ANY_SECTION));
+constexpr auto section_automaton = compileKeywords<section_vocabulary>();
+
+// Essential resume sections, whose keywords earn up to 25 points each. The keywords of all sections are
+// listed in section order in essential_keywords, so keyword i sets bit i of an essential keyword mask.
+struct EssentialSection
+{
+    string_view name;
+    size_t keyword_count;
+};
+constexpr EssentialSection essential_sections[] = {{"contact", 4}, {"education", 5}, {"experience", 4}, {"skills", 4}};
+constexpr string_view essential_keywords[] = {
+    "email", "phone", "address", "linkedin",
+    "education", "university", "college", "degree", "academic",
+    "experience", "internship", "work", "position of responsibility",
+    "skills", "technologies", "tools", "expertise"};
+
+constexpr size_t essentialKeywordTotal()
+{
+    size_t total = 0;
+    for (const auto &section : essential_sections)
+        total += section.keyword_count;
+    return total;
+}
+static_assert(essentialKeywordTotal() == size(essential_keywords), "essential_sections must cover essential_keywords");
+
+constexpr auto essential_vocabulary = eachKeywordTagged(essential_keywords);
+constexpr auto essential_automaton = compileKeywords<essential_vocabulary>();
+
+// Jobs scored as a batch: their profiles, and their skills interned into one dictionary so that each resume
+// is scanned once for all of them
+struct BatchJobs
+{
+    vector<JobProfile> profiles;
+    SkillDictionary dictionary;
+    vector<SkillJob> skills;
+
+    explicit BatchJobs(const vector<JobRequirements> &jobs)
+    {
+        profiles.reserve(jobs.size());
+        skills.reserve(jobs.size());
+        for (const auto &job : jobs)
+        {
+            profiles.emplace_back(job);
+            skills.emplace_back(dictionary, job.required_skills);
+        }
+        dictionary.compile();
+    }
+
+    size_t size() const { return profiles.size(); }
+};
+
+// A resume's scores against every job of a batch, without any strings. The found and missing skill lists
+// are not built: found holds every batch skill in the resume, and skills[j].decode(found) gives job j's.
+struct BatchRow
+{
+    int section_score = 0;
+    int format_score = 0;
+    SkillSet found;
+    vector<int> ats_scores;                                  // by job
+    vector<array<int, SECTION_SCORE_COUNT>> section_scores; // by job, in SectionScore order
+};
+
+// Every member is fixed at compile time and every method is const, so one analyzer can be shared by many threads
+class ResumeAnalyzer
+{
+private:
+
+    // Weighted sum of the component scores, each rounded separately
+    static int atsScore(const ScoringWeights &weights, int contact_score, int skills_score, int experience_score,
+                        int education_score, int format_score)
+    {
+        return static_cast<int>(round(contact_score * weights.contact)) +
+               static_cast<int>(round(skills_score * weights.skills)) +
+               static_cast<int>(round(experience_score * weights.experience)) +
+               static_cast<int>(round(education_score * weights.education)) +
+               static_cast<int>(round(format_score * weights.format));
+    }
+
+    // Deduction messages for each FormatIssue bit, in bit order
+    static constexpr const char *format_messages[] = {
+        "Resume is too short",
+        "No clear section headers found",
+        "No bullet points found for listing details",
+        "Inconsistent spacing between sections",
+        "Missing or improperly formatted contact information"};
+
+public:
+    // Documents this large or larger are analyzed in chunks of at least min_chunk_bytes when given a pool;
+    // smaller ones stay on the single-threaded path
+    static constexpr size_t parallel_analysis_bytes = 128 * 1024;
+    static constexpr size_t min_chunk_bytes = 32 * 1024;
+
+    // Calculate how many required skills are matched in the resume text
+    KeywordMatchResult calculateKeywordMatch(string_view resume_text, const vector<string> &required_skills) const
+    {
+        return calculateKeywordMatch(resume_text, SkillMatcher(required_skills));
+    }
+
+    // Match a resume against skills compiled ahead of time, so one job can be scored against many resumes
+    KeywordMatchResult calculateKeywordMatch(string_view resume_text, const SkillMatcher &matcher,
+                                             pmr::memory_resource *memory = pmr::get_default_resource()) const
+    {
+        return matcher.match(resume_text, memory);
+    }
+
+    // Check for essential resume sections and compute a total section score (max 100)
+    int checkResumeSections(string_view text) const
+    {
+        return sectionScoreFor(essentialKeywordMask(text));
+    }
+
+    // Bit i set if essential_keywords[i] occurs in text
+    uint32_t essentialKeywordMask(string_view text) const
+    {
+        return essential_automaton.matchMask(text);
+    }
+
+    // Section score of a resume containing the essential keywords in mask
+    static int sectionScoreFor(uint32_t mask)
+    {
+        int total_score = 0;
+        size_t keyword_id = 0;
+        for (const auto &section : essential_sections)
+        {
+            int found = 0;
+            for (size_t i = 0; i < section.keyword_count; i++, keyword_id++)
+            {
+                if (mask & (1u << keyword_id))
+                    found++;
+            }
+            int section_score =
+                min(25, static_cast<int>((static_cast<double>(found) / section.keyword_count) * 25));
+            total_score += section_score;
+        }
+        return total_score;
+    }
+
+    // Check formatting and return a score (out of 100) and a list of deduction messages
+    pair<int, vector<string>> checkFormatting(string_view text) const
+    {
+        FormatCheck check = checkFormatting(ResumeText(text));
+        vector<string> deductions;
+        appendFormatDeductions(check, deductions);
+        return make_pair(check.score, deductions);
+    }
+
+    FormatCheck checkFormatting(const ResumeText &doc) const
+    {
+        string_view text = doc.text();
+        const pmr::vector<string_view> &lines = doc.lines();
+        unsigned issues = 0;
+        int score = 100;
+        // Check minimum content length
+        if (text.size() < 300)
+        {
+            score -= 30;
+            issues |= RESUME_TOO_SHORT;
+        }
+        // Check for section headers (look for lines that are all uppercase)
+        bool hasSectionHeader = false;
+        for (auto ln : lines)
+        {
+            string_view trimmed = trimView(ln);
+            if (!trimmed.empty() && !textKernels().has_lowercase(trimmed.data(), trimmed.size()))
+            {
+                hasSectionHeader = true;
+                break;
+            }
+        }
+        if (!hasSectionHeader)
+        {
+            score -= 20;
+            issues |= NO_SECTION_HEADERS;
+        }
+        // Check for bullet points in lines
+        bool hasBullets = false;
+        for (auto ln : lines)
+        {
+            string_view trimmed = trimView(ln);
+            if (!trimmed.empty())
+            {
+                if (trimmed[0] == '-' || trimmed[0] == '*') // Handle single-byte characters
+                {
+                    hasBullets = true;
+                    break;
+                }
+                else if (trimmed.substr(0, 3) == "•" || trimmed.substr(0, 3) == "→") // Handle multi-byte characters
+                {
+                    hasBullets = true;
+                    break;
+                }
+            }
+        }
+        if (!hasBullets)
+        {
+            score -= 20;
+            issues |= NO_BULLET_POINTS;
+        }
+        // Check for inconsistent spacing: consecutive empty lines
+        for (size_t i = 0; i + 1 < lines.size(); i++)
+        {
+            if (trimView(lines[i]).empty() && trimView(lines[i + 1]).empty())
+            {
+                score -= 15;
+                issues |= INCONSISTENT_SPACING;
+                break;
+            }
+        }
+        // Check for proper contact information formatting
+        if (scanEmail(text, true).empty() &&
+            !containsPlainPhone(text) &&
+            scanProfileUrl(text, "linkedin.com/", false).empty())
+        {
+            score -= 15;
+            issues |= MISSING_CONTACT;
+        }
+        return FormatCheck{max(0, score), issues};
+    }
+
+    // Append the deduction message of every issue found by checkFormatting
+    static void appendFormatDeductions(const FormatCheck &check, vector<string> &out)
+    {
+        for (unsigned bit = 0; bit < size(format_messages); bit++)
+            if (check.issues & (1u << bit))
+                out.push_back(format_messages[bit]);
+    }
+
+    PersonalInfo extractPersonalInfo(string_view text) const
+    {
+        PersonalInfo info;
+        info.email = string(scanEmail(text));
+        info.phone = string(scanPhone(text));
+        info.linkedin = string(scanProfileUrl(text, "linkedin.com/in/"));
+        info.github = string(scanProfileUrl(text, "github.com/"));
+        info.codeforces = string(scanProfileUrl(text, "codeforces.com/profile/"));
+        // Assume the first non-empty line is the candidate's name.
+        info.name = string(trimView(text.substr(0, text.find('\n'))));
+        if (info.name.empty())
+            info.name = "Unknown";
+        // info.portfolio = "";
+        return info;
+    }
+
+    // Section mask of a trimmed line, as used by segmentSections
+    unsigned char classifyLine(string_view trimmed) const
+    {
+        return static_cast<unsigned char>(section_automaton.matchMask(trimmed));
+    }
+
+    // The section state machine over count lines. blank(k) and mask(k) tell whether line k is empty after
+    // trimming and give its classifyLine mask; part(i, k) adds line k to the open entry of section i
+    // (0 education, 1 experience, 2 projects) and close(i) ends that entry.
+    template <typename Blank, typename Mask, typename Part, typename Close>
+    static void walkSections(size_t count, Blank blank, Mask mask_of, Part part, Close close)
+    {
+        const unsigned char headers[] = {EDUCATION_HEADER, EXPERIENCE_HEADER, PROJECT_HEADER};
+        bool inSection[] = {false, false, false};
+        size_t open_parts[] = {0, 0, 0};
+
+        // Close the entry being collected, if it has any lines
+        auto flush = [&](int i)
+        {
+            if (open_parts[i] > 0)
+                close(i);
+            open_parts[i] = 0;
+        };
+        auto add = [&](int i, size_t k)
+        {
+            part(i, k);
+            open_parts[i]++;
+        };
+
+        for (size_t k = 0; k < count; k++)
+        {
+            bool empty = blank(k);
+            unsigned char mask = mask_of(k);
+            for (int i = 0; i < 3; i++)
+            {
+                if (mask & headers[i])
+                {
+                    // If the line is not exactly just a header, record it
+                    if (!empty)
+                        add(i, k);
+                    inSection[i] = true;
+                    continue;
+                }
+                if (!inSection[i])
+                    continue;
+                // Check if line might belong to another section using resume keywords
+                if (mask & ANY_SECTION)
+                {
+                    inSection[i] = false;
+                    flush(i);
+                    continue;
+                }
+                if (!empty)
+                    add(i, k);
+                else
+                    flush(i);
+            }
+        }
+        for (int i = 0; i < 3; i++)
+            flush(i);
+    }
+
+    // Find the education, experience and project entries in one pass over the resume lines
+    SectionViews segmentSections(const ResumeText &doc, pmr::memory_resource *memory = pmr::get_default_resource()) const
+    {
+        const pmr::vector<string_view> &lines = doc.lines();
+        SectionViews sections(memory);
+        SectionEntries *outputs[] = {&sections.education, &sections.experience, &sections.projects};
+        for (auto *output : outputs)
+        {
+            output->parts.reserve(lines.size());
+            output->entry_ends.reserve(lines.size());
+        }
+        // Each line is trimmed and classified once, when the walk reaches it
+        size_t current = SIZE_MAX;
+        string_view trimmed;
+        unsigned char mask = 0;
+        auto visit = [&](size_t k)
+        {
+            if (k != current)
+            {
+                current = k;
+                trimmed = trimView(lines[k]);
+                mask = classifyLine(trimmed);
+            }
+        };
+        walkSections(
+            lines.size(), [&](size_t k)
+            { visit(k); return trimmed.empty(); },
+            [&](size_t k)
+            { visit(k); return mask; },
+            [&](int i, size_t k)
+            { visit(k); outputs[i]->parts.push_back(trimmed); },
+            [&](int i)
+            { outputs[i]->entry_ends.push_back(outputs[i]->parts.size()); });
+        return sections;
+    }
+
+    // Extract the education, experience and project sections in one pass over the resume lines
+    ResumeSections extractSections(string_view text) const
+    {
+        ResumeText doc(text);
+        SectionViews views = segmentSections(doc);
+        return ResumeSections{views.education.materialize(), views.experience.materialize(), views.projects.materialize()};
+    }
+
+    // Extract education section(s) from the resume text
+    vector<string> extractEducation(string_view text) const
+    {
+        return extractSections(text).education;
+    }
+
+    // Extract work experience section(s) from the resume text
+    vector<string> extractExperience(string_view text) const
+    {
+        return extractSections(text).experience;
+    }
+
+    // Extract projects section(s) from the resume text
+    vector<string> extractProjects(string_view text) const
+    {
+        return extractSections(text).projects;
+    }
+
+    // Perform the overall resume analysis given the raw text and job requirements (required skills, GPA requirement, etc.)
+    ResumeAnalysisResult analyzeResume(string_view raw_text, const vector<string> &required_skills, bool require_gpa = false) const
+    {
+        return analyzeResume(raw_text, JobProfile(required_skills, require_gpa));
+    }
+
+    // Score a resume against a job compiled ahead of time; only the resume is scanned
+    ResumeAnalysisResult analyzeResume(string_view raw_text, const JobProfile &job) const
+    {
+        return scoreDocument(analyzeDocument(raw_text), raw_text, job);
+    }
+
+    // Same as analyzeResume, splitting documents of parallel_analysis_bytes or more into chunks analyzed on pool
+    ResumeAnalysisResult analyzeResume(string_view raw_text, const JobProfile &job, WorkStealingPool &pool) const
+    {
+        // Skill matches cannot cross chunks unless a skill itself contains a newline
+        for (const auto &skill : job.skills().skills())
+            if (skill.find('\n') != string::npos)
+                return scoreDocument(analyzeDocument(raw_text, pool), raw_text, job);
+        vector<char> found;
+        DocumentAnalysis analysis = analyzeDocument(raw_text, pool, &job.skills(), &found);
+        KeywordMatchResult keyword_match = job.skills().resultFor([&](size_t i)
+                                                                  { return found[i] != 0; });
+        return scoreDocument(move(analysis), move(keyword_match), job, raw_text);
+    }
+
+    // Same as analyzeResume, reusing the job-independent analysis of an identical text from cache
+    ResumeAnalysisResult analyzeResume(string_view raw_text, const JobProfile &job, AnalysisCache &cache) const
+    {
+        ContentKey key = ContentKey::of(raw_text);
+        shared_ptr<const DocumentAnalysis> analysis = cache.find(key);
+        if (!analysis)
+        {
+            analysis = make_shared<const DocumentAnalysis>(analyzeDocument(raw_text));
+            cache.insert(key, analysis);
+        }
+        return scoreDocument(*analysis, raw_text, job);
+    }
+
+    // Same as analyzeResume, reusing the job-independent analysis of a near-duplicate indexed earlier.
+    // A near-duplicate keeps its own contact details; its sections, formatting and section score are
+    // taken from the representative, while skills are always matched against its own text.
+    ResumeAnalysisResult analyzeResume(string_view raw_text, const JobProfile &job, NearDuplicateIndex &index) const
+    {
+        optional<NearDuplicateIndex::Signature> signature = NearDuplicateIndex::signatureOf(raw_text);
+        if (!signature)
+            return analyzeResume(raw_text, job);
+        shared_ptr<const DocumentAnalysis> representative = index.find(*signature);
+        if (!representative)
+        {
+            auto analysis = make_shared<const DocumentAnalysis>(analyzeDocument(raw_text));
+            index.insert(*signature, analysis);
+            return scoreDocument(*analysis, raw_text, job);
+        }
+        DocumentAnalysis analysis = *representative;
+        analysis.personal_info = extractPersonalInfo(raw_text);
+        return scoreDocument(move(analysis), raw_text, job);
+    }
+
+    // Per-line properties, named after the analysis step that uses them
+    enum LineFlag : uint16_t
+    {
+        LINE_BLANK = 1,          // empty after trimming
+        LINE_HEADER = 2,         // formatting: no lowercase letters
+        LINE_BULLET = 4,         // formatting: starts with a bullet
+        LINE_YEAR = 8,           // entry checks on the trimmed line
+        LINE_BULLET_MARK = 16,
+        LINE_ACTION_VERB = 32,
+        LINE_DEGREE = 64,
+        LINE_GPA = 128,
+        LINE_CONTACT = 256       // formatting: a word-bounded email, plain phone number or LinkedIn link
+    };
+
+    // A match inside a line, as an offset and length; length 0 when there is none
+    struct Span
+    {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+
+    // What the analysis needs to know about one '\n'-separated piece of text
+    struct LineFacts
+    {
+        uint32_t length;
+        uint32_t trim_offset;
+        uint32_t trim_length;
+        uint16_t flags;
+        unsigned char section_mask;
+        uint32_t essential_mask;
+        Span email, linkedin, github, codeforces;
+    };
+
+    // The facts of a line that depend on nothing but the line itself: trimming, the formatting flags and the
+    // section mask. The rest can also be found for many lines at once.
+    LineFacts examineLayout(string_view line) const
+    {
+        LineFacts facts{};
+        facts.length = static_cast<uint32_t>(line.size());
+        string_view trimmed = trimView(line);
+        facts.trim_offset = static_cast<uint32_t>(trimmed.empty() ? 0 : trimmed.data() - line.data());
+        facts.trim_length = static_cast<uint32_t>(trimmed.size());
+        unsigned flags = 0;
+        if (trimmed.empty())
+            flags |= LINE_BLANK;
+        else
+        {
+            if (!textKernels().has_lowercase(trimmed.data(), trimmed.size()))
+                flags |= LINE_HEADER;
+            if (trimmed[0] == '-' || trimmed[0] == '*' || trimmed.substr(0, 3) == "•" || trimmed.substr(0, 3) == "→")
+                flags |= LINE_BULLET;
+        }
+        facts.flags = static_cast<uint16_t>(flags);
+        facts.section_mask = classifyLine(trimmed);
+        return facts;
+    }
+
+    // The entry check flags of a trimmed line, which only matter for lines inside a section entry
+    static unsigned entryFlags(string_view trimmed)
+    {
+        // Lines are short, so the lowercase copy usually fits on the stack
+        char stack_buffer[256];
+        string heap_buffer;
+        char *lower_data = stack_buffer;
+        if (trimmed.size() > sizeof(stack_buffer))
+        {
+            heap_buffer.resize(trimmed.size());
+            lower_data = heap_buffer.data();
+        }
+        textKernels().to_lower(trimmed.data(), lower_data, trimmed.size());
+        string_view lower(lower_data, trimmed.size());
+        unsigned flags = 0;
+        if (containsYear(trimmed))
+            flags |= LINE_YEAR;
+        if (containsBulletMark(trimmed))
+            flags |= LINE_BULLET_MARK;
+        if (containsActionVerb(lower))
+            flags |= LINE_ACTION_VERB;
+        if (containsDegree(lower))
+            flags |= LINE_DEGREE;
+        if (containsGpaMention(lower))
+            flags |= LINE_GPA;
+        return flags;
+    }
+
+    // Whether text has contact information in the form checkFormatting looks for
+    static bool hasFormattedContact(string_view text)
+    {
+        return !scanEmail(text, true).empty() || containsPlainPhone(text) ||
+               !scanProfileUrl(text, "linkedin.com/", false).empty();
+    }
+
+    // Everything analyzeDocument learns from one '\n'-separated piece of text
+    LineFacts examineLine(string_view line) const
+    {
+        LineFacts facts = examineLayout(line);
+        unsigned flags = facts.flags | entryFlags(line.substr(facts.trim_offset, facts.trim_length));
+        if (hasFormattedContact(line))
+            flags |= LINE_CONTACT;
+        facts.flags = static_cast<uint16_t>(flags);
+        facts.essential_mask = essentialKeywordMask(line);
+        auto span = [&](string_view match)
+        {
+            Span result;
+            if (!match.empty())
+                result = {static_cast<uint32_t>(match.data() - line.data()), static_cast<uint32_t>(match.size())};
+            return result;
+        };
+        facts.email = span(scanEmail(line));
+        facts.linkedin = span(scanProfileUrl(line, "linkedin.com/in/"));
+        facts.github = span(scanProfileUrl(line, "github.com/"));
+        facts.codeforces = span(scanProfileUrl(line, "codeforces.com/profile/"));
+        return facts;
+    }
+
+    // Examine every '\n'-separated piece of text, keeping an empty piece after a trailing newline;
+    // layout_only limits it to examineLayout
+    vector<LineFacts> examineLines(string_view text, bool layout_only = false) const
+    {
+        vector<LineFacts> result;
+        while (true)
+        {
+            size_t end = textKernels().find_byte(text.data(), text.size(), '\n');
+            string_view line = text.substr(0, end);
+            result.push_back(layout_only ? examineLayout(line) : examineLine(line));
+            if (end == text.size())
+                return result;
+            text.remove_prefix(end + 1);
+        }
+    }
+
+    // analyzeDocument(text) put together from the facts of its pieces, facts_of(k) for k < piece_count,
+    // and phone, the first phone number in text
+    template <typename FactsOf>
+    DocumentAnalysis analyzeLines(string_view text, size_t piece_count, FactsOf facts_of, string_view phone) const
+    {
+        // The analyzer's lines follow getline: no empty line after a trailing newline
+        size_t line_count = piece_count - (facts_of(piece_count - 1).length == 0 ? 1 : 0);
+        vector<size_t> starts(piece_count);
+        for (size_t k = 1; k < piece_count; k++)
+            starts[k] = starts[k - 1] + facts_of(k - 1).length + 1;
+        auto trimmed = [&](size_t k)
+        {
+            return text.substr(starts[k] + facts_of(k).trim_offset, facts_of(k).trim_length);
+        };
+
+        DocumentAnalysis analysis;
+        PersonalInfo &info = analysis.personal_info;
+        auto firstMatch = [&](Span LineFacts::*field)
+        {
+            for (size_t k = 0; k < piece_count; k++)
+            {
+                const Span &match = facts_of(k).*field;
+                if (match.length > 0)
+                    return string(text.substr(starts[k] + match.offset, match.length));
+            }
+            return string();
+        };
+        info.email = firstMatch(&LineFacts::email);
+        info.phone = string(phone);
+        info.linkedin = firstMatch(&LineFacts::linkedin);
+        info.github = firstMatch(&LineFacts::github);
+        info.codeforces = firstMatch(&LineFacts::codeforces);
+        info.name = string(trimmed(0));
+        if (info.name.empty())
+            info.name = "Unknown";
+
+        SectionViews sections;
+        SectionEntries *outputs[] = {&sections.education, &sections.experience, &sections.projects};
+        unsigned section_flags[] = {0, 0, 0};
+        walkSections(
+            line_count, [&](size_t k)
+            { return (facts_of(k).flags & LINE_BLANK) != 0; },
+            [&](size_t k)
+            { return facts_of(k).section_mask; },
+            [&](int i, size_t k)
+            {
+                outputs[i]->parts.push_back(trimmed(k));
+                section_flags[i] |= facts_of(k).flags;
+            },
+            [&](int i)
+            { outputs[i]->entry_ends.push_back(outputs[i]->parts.size()); });
+        analysis.experience_has_dates = section_flags[1] & LINE_YEAR;
+        analysis.experience_has_bullets = section_flags[1] & LINE_BULLET_MARK;
+        analysis.experience_has_action_verbs = section_flags[1] & LINE_ACTION_VERB;
+        analysis.education_has_dates = section_flags[0] & LINE_YEAR;
+        analysis.education_has_degree = section_flags[0] & LINE_DEGREE;
+        analysis.education_has_gpa = section_flags[0] & LINE_GPA;
+        analysis.education = sections.education.materialize();
+        analysis.experience = sections.experience.materialize();
+        analysis.projects = sections.projects.materialize();
+
+        uint32_t essential = 0;
+        unsigned any_line = 0;
+        bool blank_pair = false;
+        for (size_t k = 0; k < piece_count; k++)
+        {
+            essential |= facts_of(k).essential_mask;
+            if (k < line_count)
+                any_line |= facts_of(k).flags;
+            if (k + 1 < line_count && (facts_of(k).flags & facts_of(k + 1).flags & LINE_BLANK))
+                blank_pair = true;
+        }
+        analysis.section_score = sectionScoreFor(essential);
+        // The same deductions, in the same order, as checkFormatting
+        FormatCheck &format = analysis.format;
+        auto deduct = [&](bool applies, int points, FormatIssue issue)
+        {
+            if (applies)
+            {
+                format.score -= points;
+                format.issues |= issue;
+            }
+        };
+        deduct(text.size() < 300, 30, RESUME_TOO_SHORT);
+        deduct(!(any_line & LINE_HEADER), 20, NO_SECTION_HEADERS);
+        deduct(!(any_line & LINE_BULLET), 20, NO_BULLET_POINTS);
+        deduct(blank_pair, 15, INCONSISTENT_SPACING);
+        deduct(!(any_line & LINE_CONTACT), 15, MISSING_CONTACT);
+        format.score = max(0, format.score);
+        return analysis;
+    }
+
+    // Split text into about count ranges of whole lines; every range but the last ends just before a '\n'
+    static vector<pair<size_t, size_t>> lineChunks(string_view text, size_t count)
+    {
+        vector<pair<size_t, size_t>> chunks;
+        size_t begin = 0;
+        for (size_t c = 1; c < count; c++)
+        {
+            size_t target = max(begin, text.size() * c / count);
+            size_t end = text.find('\n', target);
+            if (end == string_view::npos)
+                break;
+            chunks.emplace_back(begin, end);
+            begin = end + 1;
+        }
+        chunks.emplace_back(begin, text.size());
+        return chunks;
+    }
+
+    // The chunks analyzeDocument splits text into on a pool of threads threads; a single chunk when it
+    // analyzes text in one piece
+    static vector<pair<size_t, size_t>> analysisChunks(string_view text, size_t threads)
+    {
+        size_t chunk_count = min(threads * 4, text.size() / min_chunk_bytes);
+        if (text.size() < parallel_analysis_bytes || threads < 2 || chunk_count < 2)
+            return {{0, text.size()}};
+        return lineChunks(text, chunk_count);
+    }
+
+    // analyzeDocument on pool for large documents. Chunks of whole lines are laid out in parallel; the
+    // checks that need no line structure (essential keywords, contact formatting, the first email and
+    // profile links, the first phone number starting in the chunk) run on each chunk as a whole. The line
+    // facts are then merged in order, so the section state machine runs across chunk boundaries as over
+    // one document, and the entry checks run in parallel on just the lines it put into entries.
+    // When skills is given, found[i] is set for every skill i occurring in the text.
+    DocumentAnalysis analyzeDocument(string_view raw_text, WorkStealingPool &pool, const SkillMatcher *skills = nullptr,
+                                     vector<char> *found = nullptr) const
+    {
+        vector<pair<size_t, size_t>> chunks = analysisChunks(raw_text, pool.size());
+        if (chunks.size() < 2)
+        {
+            if (skills)
+            {
+                found->assign(skills->skills().size(), 0);
+                skills->forEachFound(raw_text, [&](size_t i)
+                                     { (*found)[i] = 1; });
+            }
+            return analyzeDocument(raw_text);
+        }
+        vector<vector<LineFacts>> chunk_facts(chunks.size());
+        vector<string_view> chunk_phones(chunks.size());
+        vector<vector<char>> chunk_found(chunks.size());
+        pool.parallelFor(chunks.size(), [&](size_t begin, size_t end)
+                         {
+                             for (size_t c = begin; c < end; c++)
+                             {
+                                 string_view chunk = raw_text.substr(chunks[c].first, chunks[c].second - chunks[c].first);
+                                 vector<LineFacts> &facts = chunk_facts[c];
+                                 facts = examineLines(chunk, true);
+                                 // Only unions of these over all lines are used, so the chunk's first line carries them
+                                 facts[0].essential_mask = essentialKeywordMask(chunk);
+                                 if (hasFormattedContact(chunk))
+                                     facts[0].flags |= LINE_CONTACT;
+                                 // No match contains a newline, so each lies within the line it starts in
+                                 auto place = [&](string_view match, Span LineFacts::*field)
+                                 {
+                                     if (match.empty())
+                                         return;
+                                     size_t offset = match.data() - chunk.data(), line_start = 0, k = 0;
+                                     while (line_start + facts[k].length < offset)
+                                         line_start += facts[k++].length + 1;
+                                     facts[k].*field = {static_cast<uint32_t>(offset - line_start),
+                                                        static_cast<uint32_t>(match.size())};
+                                 };
+                                 place(scanEmail(chunk), &LineFacts::email);
+                                 place(scanProfileUrl(chunk, "linkedin.com/in/"), &LineFacts::linkedin);
+                                 place(scanProfileUrl(chunk, "github.com/"), &LineFacts::github);
+                                 place(scanProfileUrl(chunk, "codeforces.com/profile/"), &LineFacts::codeforces);
+                                 // A phone number starting in this chunk may run on into the next. The '\n'
+                                 // ending the chunk is a start too, as \s* lets a match begin there.
+                                 chunk_phones[c] = scanPhone(raw_text.substr(chunks[c].first),
+                                                             chunk.size() + (c + 1 < chunks.size() ? 1 : 0));
+                                 if (skills)
+                                 {
+                                     ScratchScope scratch;
+                                     chunk_found[c].assign(skills->skills().size(), 0);
+                                     skills->forEachFound(chunk, [&](size_t i)
+                                                          { chunk_found[c][i] = 1; }, scratch.resource());
+                                 }
+                             } });
+
+        vector<LineFacts> pieces;
+        string_view phone;
+        for (size_t c = 0; c < chunks.size(); c++)
+        {
+            pieces.insert(pieces.end(), chunk_facts[c].begin(), chunk_facts[c].end());
+            if (phone.empty())
+                phone = chunk_phones[c];
+        }
+        if (skills)
+        {
+            found->assign(skills->skills().size(), 0);
+            for (const auto &flags : chunk_found)
+                for (size_t i = 0; i < flags.size(); i++)
+                    (*found)[i] |= flags[i];
+        }
+
+        size_t line_count = pieces.size() - (pieces.back().length == 0 ? 1 : 0);
+        vector<size_t> starts(pieces.size());
+        for (size_t k = 1; k < pieces.size(); k++)
+            starts[k] = starts[k - 1] + pieces[k - 1].length + 1;
+        vector<size_t> entry_lines;
+        walkSections(
+            line_count, [&](size_t k)
+            { return (pieces[k].flags & LINE_BLANK) != 0; },
+            [&](size_t k)
+            { return pieces[k].section_mask; },
+            [&](int, size_t k)
+            {
+                if (entry_lines.empty() || entry_lines.back() != k)
+                    entry_lines.push_back(k);
+            },
+            [](int) {});
+        pool.parallelFor(entry_lines.size(), [&](size_t begin, size_t end)
+                         {
+                             for (size_t e = begin; e < end; e++)
+                             {
+                                 LineFacts &facts = pieces[entry_lines[e]];
+                                 string_view trimmed = raw_text.substr(starts[entry_lines[e]] + facts.trim_offset, facts.trim_length);
+                                 facts.flags = static_cast<uint16_t>(facts.flags | entryFlags(trimmed));
+                             } });
+        return analyzeLines(
+            raw_text, pieces.size(), [&](size_t k) -> const LineFacts &
+            { return pieces[k]; },
+            phone);
+    }
+
+    // The experience and education checks of analyzeDocument. They run on each line of an entry,
+    // which finds the same words as searching the joined entry.
+    void checkEntries(const ResumeText &doc, const SectionViews &sections, DocumentScores &scores) const
+    {
+        for (auto part : sections.experience.parts)
+        {
+            if (containsYear(part))
+                scores.experience_has_dates = true;
+            if (containsBulletMark(part))
+                scores.experience_has_bullets = true;
+            if (containsActionVerb(doc.lowered(part)))
+                scores.experience_has_action_verbs = true;
+        }
+        for (auto part : sections.education.parts)
+        {
+            if (containsYear(part))
+                scores.education_has_dates = true;
+            if (containsDegree(doc.lowered(part)))
+                scores.education_has_degree = true;
+            if (containsGpaMention(doc.lowered(part)))
+                scores.education_has_gpa = true;
+        }
+    }
+
+    // The score-relevant part of a full analysis
+    static DocumentScores documentScores(const DocumentAnalysis &analysis)
+    {
+        DocumentScores scores;
+        scores.has_email = !analysis.personal_info.email.empty();
+        scores.has_phone = !analysis.personal_info.phone.empty();
+        scores.has_linkedin = !analysis.personal_info.linkedin.empty();
+        scores.has_education = !analysis.education.empty();
+        scores.has_experience = !analysis.experience.empty();
+        scores.experience_has_dates = analysis.experience_has_dates;
+        scores.experience_has_bullets = analysis.experience_has_bullets;
+        scores.experience_has_action_verbs = analysis.experience_has_action_verbs;
+        scores.education_has_dates = analysis.education_has_dates;
+        scores.education_has_degree = analysis.education_has_degree;
+        scores.education_has_gpa = analysis.education_has_gpa;
+        scores.section_score = analysis.section_score;
+        scores.format = analysis.format;
+        return scores;
+    }
+
+    // documentScores(analyzeDocument(raw_text)) without building any string: contact details are only
+    // searched for and the section entries stay views into the text
+    DocumentScores documentScores(string_view raw_text) const
+    {
+        ScratchScope scratch;
+        ResumeText doc(raw_text, scratch.resource());
+        return documentScores(doc, segmentSections(doc, scratch.resource()));
+    }
+
+    // Same, for a resume already normalized into doc and split into sections
+    DocumentScores documentScores(const ResumeText &doc, const SectionViews &sections) const
+    {
+        string_view raw_text = doc.text();
+        DocumentScores scores;
+        scores.has_email = !scanEmail(raw_text).empty();
+        scores.has_phone = !scanPhone(raw_text).empty();
+        scores.has_linkedin = !scanProfileUrl(raw_text, "linkedin.com/in/").empty();
+        scores.has_education = !sections.education.empty();
+        scores.has_experience = !sections.experience.empty();
+        scores.section_score = checkResumeSections(raw_text);
+        scores.format = checkFormatting(doc);
+        checkEntries(doc, sections, scores);
+        return scores;
+    }
+
+    // Everything about a resume that does not depend on the job
+    DocumentAnalysis analyzeDocument(string_view raw_text) const
+    {
+        ScratchScope scratch;
+        StageClock clock(raw_text.size());
+        ResumeText doc(raw_text, scratch.resource());
+        clock.lap(STAGE_NORMALIZE);
+        return analyzeDocument(doc, scratch.resource());
+    }
+
+    // Same, for a resume already normalized into doc; the section views are allocated from memory
+    DocumentAnalysis analyzeDocument(const ResumeText &doc, pmr::memory_resource *memory) const
+    {
+        string_view raw_text = doc.text();
+        StageClock clock(raw_text.size());
+        DocumentAnalysis analysis;
+        analysis.personal_info = extractPersonalInfo(raw_text);
+        clock.lap(STAGE_PERSONAL_INFO);
+        SectionViews sections = segmentSections(doc, memory);
+        clock.lap(STAGE_SEGMENT_SECTIONS);
+        analysis.section_score = checkResumeSections(raw_text);
+        clock.lap(STAGE_SECTION_SCORE);
+        analysis.format = checkFormatting(doc);
+        clock.lap(STAGE_FORMATTING);
+
+        DocumentScores entries;
+        checkEntries(doc, sections, entries);
+        analysis.experience_has_dates = entries.experience_has_dates;
+        analysis.experience_has_bullets = entries.experience_has_bullets;
+        analysis.experience_has_action_verbs = entries.experience_has_action_verbs;
+        analysis.education_has_dates = entries.education_has_dates;
+        analysis.education_has_degree = entries.education_has_degree;
+        analysis.education_has_gpa = entries.education_has_gpa;
+
+        // Only now do the section entries become strings
+        analysis.education = sections.education.materialize();
+        analysis.experience = sections.experience.materialize();
+        analysis.projects = sections.projects.materialize();
+        clock.lap(STAGE_ENTRY_CHECKS);
+        return analysis;
+    }
+
+    // The suggestions behind the contact, experience and education components, in the order they are
+    // reported; each component is 100 minus 25 per suggestion
+    struct Deductions
+    {
+        const char *contact[3];
+        size_t contact_count = 0;
+        const char *experience[3];
+        size_t experience_count = 0;
+        const char *education[3];
+        size_t education_count = 0;
+
+        int contactScore() const { return 100 - static_cast<int>(contact_count) * 25; }
+        int experienceScore() const { return 100 - static_cast<int>(experience_count) * 25; }
+        int educationScore() const { return 100 - static_cast<int>(education_count) * 25; }
+    };
+
+    Deductions deductionsFor(const DocumentScores &scores, const JobProfile &job) const
+    {
+        Deductions d;
+        // Contact information
+        if (!scores.has_email)
+            d.contact[d.contact_count++] = "Add your email address";
+        if (!scores.has_phone)
+            d.contact[d.contact_count++] = "Add your phone number";
+        if (!scores.has_linkedin)
+            d.contact[d.contact_count++] = "Add your LinkedIn profile URL";
+
+        // Experience section
+        if (!scores.has_experience)
+        {
+            d.experience[d.experience_count++] = "Add your work experience section";
+        }
+        else
+        {
+            if (!scores.experience_has_dates)
+                d.experience[d.experience_count++] = "Include dates for each work experience";
+            if (!scores.experience_has_bullets)
+                d.experience[d.experience_count++] = "Use bullet points to list your achievements and responsibilities";
+            if (!scores.experience_has_action_verbs)
+                d.experience[d.experience_count++] = "Start bullet points with strong action verbs";
+        }
+
+        // Education section
+        if (!scores.has_education)
+        {
+            d.education[d.education_count++] = "Add your educational background";
+        }
+        else
+        {
+            if (!scores.education_has_dates)
+                d.education[d.education_count++] = "Include graduation dates";
+            if (!scores.education_has_degree)
+                d.education[d.education_count++] = "Specify your degree type";
+            if (!scores.education_has_gpa && job.requireGpa())
+                d.education[d.education_count++] = "Include your CGPA if it's above 7.0";
+        }
+        return d;
+    }
+
+    int atsScoreFor(const DocumentScores &scores, const Deductions &deductions, int skills_score,
+                    const JobProfile &job) const
+    {
+        return atsScore(job.weights(), deductions.contactScore(), skills_score, deductions.experienceScore(),
+                        deductions.educationScore(), scores.format.score);
+    }
+
+    // The suggestions of a result: contact, missing skills, experience, education, then formatting
+    vector<string> suggestionsFor(const DocumentScores &scores, const Deductions &d,
+                                  const vector<string> &missing) const
+    {
+        vector<string> suggestions;
+        suggestions.reserve(d.contact_count + (missing.empty() ? 0 : missing.size() + 1) + d.experience_count +
+                            d.education_count + size(format_messages));
+        suggestions.insert(suggestions.end(), d.contact, d.contact + d.contact_count);
+        if (!missing.empty())
+        {
+            suggestions.push_back("Mising skills are: ");
+            suggestions.insert(suggestions.end(), missing.begin(), missing.end());
+        }
+        suggestions.insert(suggestions.end(), d.experience, d.experience + d.experience_count);
+        suggestions.insert(suggestions.end(), d.education, d.education + d.education_count);
+        // Formatting suggestions
+        if (scores.format.score < 100)
+            appendFormatDeductions(scores.format, suggestions);
+        if (suggestions.empty())
+            suggestions.push_back("Your resume is well-optimized for ATS systems");
+        return suggestions;
+    }
+
+    map<string, int> sectionScoresFor(const DocumentScores &scores, const Deductions &deductions, int skills_score) const
+    {
+        map<string, int> section_scores;
+        section_scores["contact"] = deductions.contactScore();
+        section_scores["skills"] = skills_score;
+        section_scores["experience"] = deductions.experienceScore();
+        section_scores["education"] = deductions.educationScore();
+        section_scores["format"] = scores.format.score;
+        return section_scores;
+    }
+
+    // analyzeResume(raw_text, job).ats_score without building the result: no contact strings, section
+    // entries, found/missing skill lists, suggestions or section score map
+    int atsScoreOnly(string_view raw_text, const JobProfile &job) const
+    {
+        DocumentScores scores = documentScores(raw_text);
+        size_t found;
+        {
+            ScratchScope scratch;
+            found = job.skills().countMatches(raw_text, scratch.resource());
+        }
+        int relevance = job.relevance() ? job.relevance()->score(raw_text) : -1;
+        int skills_score = job.skillsComponent(keywordScore(found, job.skills().skills().size()), relevance);
+        return atsScoreFor(scores, deductionsFor(scores, job), skills_score, job);
+    }
+
+    // Combine a job-independent analysis with the job-dependent keyword match into the final result;
+    // raw_text is the resume the analysis was made from. An unscored relevance is computed from the job.
+    ResumeAnalysisResult scoreDocument(DocumentAnalysis analysis, string_view raw_text, const JobProfile &job,
+                                       int relevance = KeywordMatchResult::unscored) const
+    {
+        KeywordMatchResult keyword_match;
+        {
+            ScratchScope scratch;
+            StageClock clock(raw_text.size());
+            keyword_match = calculateKeywordMatch(raw_text, job.skills(), scratch.resource());
+            clock.lap(STAGE_KEYWORD_MATCH);
+        }
+        keyword_match.relevance = relevance;
+        return scoreDocument(move(analysis), move(keyword_match), job, raw_text);
+    }
+
+    // Same, with the skill matches (and possibly the relevance) already known
+    ResumeAnalysisResult scoreDocument(DocumentAnalysis analysis, KeywordMatchResult keyword_match,
+                                       const JobProfile &job, string_view raw_text) const
+    {
+        StageClock clock(raw_text.size());
+        if (keyword_match.relevance == KeywordMatchResult::unscored)
+        {
+            keyword_match.relevance = -1;
+            if (job.relevance())
+            {
+                keyword_match.relevance = job.relevance()->score(raw_text);
+                clock.lap(STAGE_RELEVANCE);
+            }
+        }
+        DocumentScores scores = documentScores(analysis);
+        Deductions deductions = deductionsFor(scores, job);
+        ResumeAnalysisResult result;
+        result.personal_info = move(analysis.personal_info);
+        result.keyword_match = move(keyword_match);
+        result.section_score = analysis.section_score;
+        result.format_score = analysis.format.score;
+        int skills_score = job.skillsComponent(result.keyword_match.score, result.keyword_match.relevance);
+        result.ats_score = atsScoreFor(scores, deductions, skills_score, job);
+        result.education = move(analysis.education);
+        result.experience = move(analysis.experience);
+        result.projects = move(analysis.projects);
+        result.suggestions = suggestionsFor(scores, deductions, result.keyword_match.missing_skills);
+        result.section_scores = sectionScoresFor(scores, deductions, skills_score);
+        clock.lap(STAGE_SUGGESTIONS);
+
+        return result;
+    }
+
+    // Score every resume against every job on the pool's workers; results[r][j] is resume r against job j.
+    // Each resume's job-independent analysis is done once and its row is filled by one task, so the results
+    // do not depend on the number of threads.
+    vector<vector<ResumeAnalysisResult>> analyzeBatch(const vector<string> &resumes, const vector<JobRequirements> &jobs,
+                                                      WorkStealingPool &pool) const
+    {
+        BatchJobs batch(jobs);
+        vector<vector<ResumeAnalysisResult>> results(resumes.size(), vector<ResumeAnalysisResult>(jobs.size()));
+        // Each resume is scanned once for the skills of every job
+        pool.parallelFor(resumes.size(), [&](size_t begin, size_t end)
+                         {
+                             for (size_t r = begin; r < end; r++)
+                             {
+                                 DocumentAnalysis analysis = analyzeDocument(resumes[r]);
+                                 SkillSet found = batch.dictionary.scan(resumes[r]);
+                                 for (size_t j = 0; j < jobs.size(); j++)
+                                     results[r][j] = scoreDocument(analysis, batch.skills[j].decode(found),
+                                                                   batch.profiles[j], resumes[r]);
+                             } });
+        return results;
+    }
+
+    // The scores of analyzeBatch without building a single string: no contact details, section entries,
+    // skill lists or suggestions. rows[r] is resume r; its skill lists are decoded only if asked for.
+    vector<BatchRow> scoreBatch(const vector<string> &resumes, const BatchJobs &jobs, WorkStealingPool &pool) const
+    {
+        vector<BatchRow> rows(resumes.size());
+        pool.parallelFor(resumes.size(), [&](size_t begin, size_t end)
+                         {
+                             for (size_t r = begin; r < end; r++)
+                             {
+                                 DocumentScores scores = documentScores(resumes[r]);
+                                 BatchRow &row = rows[r];
+                                 row.section_score = scores.section_score;
+                                 row.format_score = scores.format.score;
+                                 {
+                                     ScratchScope scratch;
+                                     row.found = jobs.dictionary.scan(resumes[r], scratch.resource());
+                                 }
+                                 for (size_t j = 0; j < jobs.size(); j++)
+                                 {
+                                     const JobProfile &job = jobs.profiles[j];
+                                     Deductions deductions = deductionsFor(scores, job);
+                                     int relevance = job.relevance() ? job.relevance()->score(resumes[r]) : -1;
+                                     int skills_score = job.skillsComponent(
+                                         keywordScore(jobs.skills[j].countMatches(row.found), jobs.skills[j].skills().size()),
+                                         relevance);
+                                     row.ats_scores.push_back(atsScoreFor(scores, deductions, skills_score, job));
+                                     row.section_scores.push_back({deductions.contactScore(), skills_score,
+                                                                   deductions.experienceScore(),
+                                                                   deductions.educationScore(), scores.format.score});
+                                 }
+                             } });
+        return rows;
+    }
+
+    // The k best resumes for a job, best first (higher ATS score, then earlier input position). The skills
+    // component is computed for every resume and the other components are assumed perfect, giving an upper
+    // bound on its ATS score; a resume is only fully analyzed if that bound could still enter the current
+    // top k, so the result is the same as scoring every resume. Assumes non-negative scoring weights.
+    vector<RankedResume> rankTopK(const vector<string> &resumes, const JobProfile &job, size_t k,
+                                  RankingStats *stats = nullptr) const
+    {
+        RankingStats counters;
+        counters.candidates = resumes.size();
+        vector<pair<int, size_t>> bounds; // (upper bound, index)
+        bounds.reserve(resumes.size());
+        for (size_t i = 0; i < resumes.size(); i++)
+        {
+            ScratchScope scratch;
+            size_t found = job.skills().countMatches(resumes[i], scratch.resource());
+            int skills_score = job.skills().scoreFor(found);
+            // With a description, relevance is bounded by 100 rather than computed
+            if (job.relevance())
+                skills_score = job.skillsComponent(keywordScore(found, job.skills().skills().size()), 100);
+            bounds.emplace_back(atsScore(job.weights(), 100, skills_score, 100, 100, 100), i);
+        }
+        // Most promising resumes first, so the heap fills with good scores early
+        sort(bounds.begin(), bounds.end(), [](const auto &a, const auto &b)
+             { return a.first != b.first ? a.first > b.first : a.second < b.second; });
+
+        auto better = [](const RankedResume &a, const RankedResume &b)
+        {
+            return a.result.ats_score != b.result.ats_score ? a.result.ats_score > b.result.ats_score : a.index < b.index;
+        };
+        // Heap ordered so that the worst of the current top k is at the front
+        vector<RankedResume> top;
+        top.reserve(k + 1);
+        for (const auto &[bound, index] : bounds)
+        {
+            if (k == 0)
+                break;
+            if (top.size() == k)
+            {
+                const RankedResume &worst = top.front();
+                if (bound < worst.result.ats_score)
+                    break; // every remaining bound is at most this one
+                if (bound == worst.result.ats_score && index > worst.index)
+                    continue;
+            }
+            RankedResume candidate{index, analyzeResume(resumes[index], job)};
+            counters.fully_analyzed++;
+            if (top.size() < k)
+            {
+                top.push_back(move(candidate));
+                push_heap(top.begin(), top.end(), better);
+            }
+            else if (better(candidate, top.front()))
+            {
+                pop_heap(top.begin(), top.end(), better);
+                top.back() = move(candidate);
+                push_heap(top.begin(), top.end(), better);
+            }
+        }
+        sort(top.begin(), top.end(), better);
+        counters.skipped = counters.candidates - counters.fully_analyzed;
+        if (stats)
+            *stats = counters;
+        return top;
+    }
+};
+
+// A resume being edited, scored against one job. Everything the analysis learns from a single line is
+// kept per line, so an edit only re-examines the lines it touches; score() then combines the cached
+// lines in one cheap pass. score() always returns what analyzeResume(text(), job) would.
+class ResumeEditSession
+{
+private:
+    // Facts of one piece plus the indices of the job's skills that occur in it
+    struct Piece
+    {
+        ResumeAnalyzer::LineFacts facts;
+        vector<uint32_t> skills;
+    };
+
+    const ResumeAnalyzer &analyzer;
+    const JobProfile &job;
+    string current;
+    // One entry per '\n'-separated piece of the text, so a text ending in '\n' has an empty last piece
+    vector<Piece> pieces;
+    // Skill matches cannot cross lines unless a skill itself contains a newline
+    bool skills_by_line = true;
+
+    vector<Piece> examineAll(string_view text) const
+    {
+        vector<Piece> result;
+        for (auto &facts : analyzer.examineLines(text))
+            result.push_back({move(facts), {}});
+        if (skills_by_line)
+        {
+            size_t start = 0;
+            for (auto &piece : result)
+            {
+                job.skills().forEachFound(text.substr(start, piece.facts.length), [&](size_t i)
+                                          { piece.skills.push_back(static_cast<uint32_t>(i)); });
+                start += piece.facts.length + 1;
+            }
+        }
+        return result;
+    }
+
+public:
+    // analyzer and job must outlive the session
+    ResumeEditSession(const ResumeAnalyzer &resume_analyzer, const JobProfile &job_profile, string text)
+        : analyzer(resume_analyzer), job(job_profile), current(move(text))
+    {
+        for (const auto &skill : job.skills().skills())
+            if (skill.find('\n') != string::npos)
+                skills_by_line = false;
+        pieces = examineAll(current);
+    }
+
+    const string &text() const { return current; }
+
+    // Replace length bytes at pos with replacement (clamped to the end of the text)
+    void edit(size_t pos, size_t length, string_view replacement)
+    {
+        if (pos > current.size())
+            throw out_of_range("edit position " + to_string(pos) + " is past the end of the resume");
+        length = min(length, current.size() - pos);
+        // Pieces first..last hold the edited range: a piece owns its bytes and the newline after it
+        size_t first = 0, region_start = 0;
+        while (region_start + pieces[first].facts.length < pos)
+            region_start += pieces[first++].facts.length + 1;
+        size_t last = first, region_end = region_start + pieces[first].facts.length;
+        while (region_end < pos + length)
+            region_end += 1 + pieces[++last].facts.length;
+        current.replace(pos, length, replacement);
+        region_end = region_end - length + replacement.size();
+        vector<Piece> fresh = examineAll(string_view(current).substr(region_start, region_end - region_start));
+        pieces.erase(pieces.begin() + first, pieces.begin() + last + 1);
+        pieces.insert(pieces.begin() + first, make_move_iterator(fresh.begin()), make_move_iterator(fresh.end()));
+    }
+
+    ResumeAnalysisResult score() const
+    {
+        // Phone numbers may span lines (\s* matches newlines), so they are always searched in the whole text
+        DocumentAnalysis analysis = analyzer.analyzeLines(
+            current, pieces.size(), [&](size_t k) -> const ResumeAnalyzer::LineFacts &
+            { return pieces[k].facts; },
+            scanPhone(current));
+        KeywordMatchResult keyword_match;
+        if (skills_by_line)
+        {
+            vector<char> found(job.skills().skills().size(), 0);
+            for (const auto &piece : pieces)
+                for (uint32_t i : piece.skills)
+                    found[i] = 1;
+            keyword_match = job.skills().resultFor([&](size_t i)
+                                                   { return found[i] != 0; });
+        }
+        else
+            keyword_match = analyzer.calculateKeywordMatch(current, job.skills());
+        return analyzer.scoreDocument(move(analysis), move(keyword_match), job, current);
+    }
+};
+
+// One resume's analysis against one job, each field computed on first access and kept. A caller that
+// only reads atsScore() pays for the score-only path (ResumeAnalyzer::atsScoreOnly). The normalized text
+// and section views behind the score are kept, so reading the entries or result() later only extracts the
+// contact details and turns the entries into strings; result() always equals analyzeResume(text, job).
+// The text and job must outlive the handle, which is not meant to be shared between threads.
+class LazyResumeAnalysis
+{
+private:
+    const ResumeAnalyzer &analyzer;
+    string_view text;
+    const JobProfile &job;
+    mutable optional<ResumeText> doc;
+    mutable optional<SectionViews> sections;
+    mutable optional<DocumentAnalysis> document;
+    mutable optional<DocumentScores> scores;
+    mutable optional<PersonalInfo> personal;
+    mutable optional<KeywordMatchResult> keyword_match;
+    mutable optional<double> keyword_score;
+    mutable optional<int> relevance;
+    mutable optional<int> ats_score;
+    mutable optional<vector<string>> suggestion_list;
+    mutable optional<map<string, int>> section_score_map;
+
+    const ResumeText &normalized() const
+    {
+        if (!doc)
+            doc.emplace(text);
+        return *doc;
+    }
+
+    const SectionViews &sectionViews() const
+    {
+        if (!sections)
+            sections = analyzer.segmentSections(normalized());
+        return *sections;
+    }
+
+    // What analyzeDocument(text) returns, assembled from the pieces the score already computed
+    const DocumentAnalysis &fullDocument() const
+    {
+        if (!document)
+        {
+            const DocumentScores &s = documentScores();
+            DocumentAnalysis analysis;
+            analysis.personal_info = personalInfo();
+            analysis.section_score = s.section_score;
+            analysis.format = s.format;
+            analysis.experience_has_dates = s.experience_has_dates;
+            analysis.experience_has_bullets = s.experience_has_bullets;
+            analysis.experience_has_action_verbs = s.experience_has_action_verbs;
+            analysis.education_has_dates = s.education_has_dates;
+            analysis.education_has_degree = s.education_has_degree;
+            analysis.education_has_gpa = s.education_has_gpa;
+            analysis.education = sectionViews().education.materialize();
+            analysis.experience = sectionViews().experience.materialize();
+            analysis.projects = sectionViews().projects.materialize();
+            document = move(analysis);
+        }
+        return *document;
+    }
+
+    int relevanceScore() const
+    {
+        if (!relevance)
+            relevance = job.relevance() ? job.relevance()->score(text) : -1;
+        return *relevance;
+    }
+
+    int skillsScore() const
+    {
+        if (!keyword_score)
+        {
+            ScratchScope scratch;
+            keyword_score = keywordScore(job.skills().countMatches(text, scratch.resource()), job.skills().skills().size());
+        }
+        return job.skillsComponent(*keyword_score, relevanceScore());
+    }
+
+public:
+    LazyResumeAnalysis(const ResumeAnalyzer &analyzer, string_view text, const JobProfile &job)
+        : analyzer(analyzer), text(text), job(job) {}
+
+    const DocumentScores &documentScores() const
+    {
+        if (!scores)
+            scores = analyzer.documentScores(normalized(), sectionViews());
+        return *scores;
+    }
+
+    int atsScore() const
+    {
+        if (!ats_score)
+            ats_score = analyzer.atsScoreFor(documentScores(), analyzer.deductionsFor(documentScores(), job),
+                                             skillsScore(), job);
+        return *ats_score;
+    }
+
+    int sectionScore() const { return documentScores().section_score; }
+    int formatScore() const { return documentScores().format.score; }
+
+    const PersonalInfo &personalInfo() const
+    {
+        if (!personal)
+            personal = document ? document->personal_info : analyzer.extractPersonalInfo(text);
+        return *personal;
+    }
+
+    const KeywordMatchResult &keywordMatch() const
+    {
+        if (!keyword_match)
+        {
+            keyword_match = analyzer.calculateKeywordMatch(text, job.skills());
+            keyword_match->relevance = relevanceScore();
+            keyword_score = keyword_match->score;
+        }
+        return *keyword_match;
+    }
+
+    const vector<string> &education() const { return fullDocument().education; }
+    const vector<string> &experience() const { return fullDocument().experience; }
+    const vector<string> &projects() const { return fullDocument().projects; }
+
+    const vector<string> &suggestions() const
+    {
+        if (!suggestion_list)
+            suggestion_list = analyzer.suggestionsFor(documentScores(), analyzer.deductionsFor(documentScores(), job),
+                                                      keywordMatch().missing_skills);
+        return *suggestion_list;
+    }
+
+    const map<string, int> &sectionScores() const
+    {
+        if (!section_score_map)
+            section_score_map = analyzer.sectionScoresFor(documentScores(), analyzer.deductionsFor(documentScores(), job),
+                                                          skillsScore());
+        return *section_score_map;
+    }
+
+    // Every field, as analyzeResume(text, job) returns it
+    ResumeAnalysisResult result() const
+    {
+        ResumeAnalysisResult full;
+        full.personal_info = personalInfo();
+        full.ats_score = atsScore();
+        full.keyword_match = keywordMatch();
+        full.section_score = sectionScore();
+        full.format_score = formatScore();
+        full.education = education();
+        full.experience = experience();
+        full.projects = projects();
+        full.suggestions = suggestions();
+        full.section_scores = sectionScores();
+        return full;
+    }
+};
+
+// Read-only memory mapping of a whole file
+class MappedFile
+{
+private:
+    const char *data = nullptr;
+    size_t length = 0;
+
+public:
+    explicit MappedFile(const string &path)
+    {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw runtime_error(path + ": " + strerror(errno));
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            close(fd);
+            throw runtime_error(path + ": " + strerror(errno));
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0)
+        {
+            void *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED)
+            {
+                close(fd);
+                throw runtime_error(path + ": " + strerror(errno));
+            }
+            madvise(mapping, length, MADV_SEQUENTIAL);
+            data = static_cast<const char *>(mapping);
+        }
+        close(fd);
+    }
+
+    ~MappedFile()
+    {
+        if (data)
+            munmap(const_cast<char *>(data), length);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    string_view view() const { return string_view(data, length); }
+};
+
+// Append s to out as a quoted JSON string
+void appendJsonString(string &out, string_view s)
+{
+    static const char hex[] = "0123456789abcdef";
+    out.push_back('"');
+    for (char c : s)
+    {
+        unsigned char b = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\')
+        {
+            out.push_back('\\');
+            out.push_back(c);
+        }
+        else if (c == '\n')
+            out.append("\\n");
+        else if (c == '\t')
+            out.append("\\t");
+        else if (c == '\r')
+            out.append("\\r");
+        else if (b < 0x20)
+        {
+            out.append("\\u00");
+            out.push_back(hex[b >> 4]);
+            out.push_back(hex[b & 15]);
+        }
+        else
+            out.push_back(c);
+    }
+    out.push_back('"');
+}
+
+// Minimal reader for one JSON value per line: pulls string fields out of an object and skips the rest
+class JsonLineReader
+{
+private:
+    string_view in;
+    size_t pos = 0;
+
+    void skipSpaces()
+    {
+        while (pos < in.size() && isSpaceChar(in[pos]))
+            pos++;
+    }
+
+    bool expect(char c)
+    {
+        skipSpaces();
+        if (pos >= in.size() || in[pos] != c)
+            return false;
+        pos++;
+        return true;
+    }
+
+    static void appendUtf8(string &out, uint32_t code)
+    {
+        if (code < 0x80)
+            out.push_back(static_cast<char>(code));
+        else if (code < 0x800)
+        {
+            out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+        else if (code < 0x10000)
+        {
+            out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+        else
+        {
+            out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+    }
+
+    bool readHex4(uint32_t &code)
+    {
+        if (pos + 4 > in.size())
+            return false;
+        code = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            char c = in[pos++];
+            code <<= 4;
+            if (c >= '0' && c <= '9')
+                code |= c - '0';
+            else if (c >= 'a' && c <= 'f')
+                code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                code |= c - 'A' + 10;
+            else
+                return false;
+        }
+        return true;
+    }
+
+    // Decode a JSON string into out (replacing its contents)
+    bool readString(string &out)
+    {
+        out.clear();
+        if (!expect('"'))
+            return false;
+        while (pos < in.size())
+        {
+            size_t stop = in.find_first_of("\"\\", pos);
+            if (stop == string_view::npos)
+                return false;
+            out.append(in.substr(pos, stop - pos));
+            pos = stop + 1;
+            if (in[stop] == '"')
+                return true;
+            if (pos >= in.size())
+                return false;
+            char escape = in[pos++];
+            switch (escape)
+            {
+            case 'n': out.push_back('\n'); break;
+            case 't': out.push_back('\t'); break;
+            case 'r': out.push_back('\r'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'u':
+            {
+                uint32_t code;
+                if (!readHex4(code))
+                    return false;
+                // Combine a UTF-16 surrogate pair into one code point
+                if (code >= 0xD800 && code < 0xDC00 && in.substr(pos, 2) == "\\u")
+                {
+                    pos += 2;
+                    uint32_t low;
+                    if (!readHex4(low))
+                        return false;
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, code);
+                break;
+            }
+            default: out.push_back(escape); break;
+            }
+        }
+        return false;
+    }
+
+    // Skip any JSON value, returning the raw text it covered
+    bool skipValue(string_view &raw)
+    {
+        skipSpaces();
+        size_t start = pos;
+        int depth = 0;
+        string scratch;
+        while (pos < in.size())
+        {
+            char c = in[pos];
+            if (c == '"')
+            {
+                if (!readString(scratch))
+                    return false;
+            }
+            else if (c == '{' || c == '[')
+            {
+                depth++;
+                pos++;
+            }
+            else if (c == '}' || c == ']')
+            {
+                if (depth == 0)
+                    break;
+                depth--;
+                pos++;
+            }
+            else if (c == ',' && depth == 0)
+                break;
+            else
+                pos++;
+            if (depth == 0 && (c == '"' || c == '}' || c == ']'))
+                break;
+        }
+        raw = trimView(in.substr(start, pos - start));
+        return depth == 0 && !raw.empty();
+    }
+
+public:
+    // Read a line holding either a JSON string or an object with a "text" field (and optional "id")
+    bool parse(string_view line, string &id, string &text)
+    {
+        in = line;
+        pos = 0;
+        id.clear();
+        skipSpaces();
+        if (pos < in.size() && in[pos] == '"')
+            return readString(text);
+        if (!expect('{'))
+            return false;
+        bool has_text = false;
+        string key;
+        while (true)
+        {
+            if (!readString(key) || !expect(':'))
+                return false;
+            skipSpaces();
+            if ((key == "text" || key == "id") && pos < in.size() && in[pos] == '"')
+            {
+                if (!readString(key == "text" ? text : id))
+                    return false;
+                has_text = has_text || key == "text";
+            }
+            else
+            {
+                string_view raw;
+                if (!skipValue(raw))
+                    return false;
+                if (key == "id")
+                    id = string(raw);
+            }
+            if (expect('}'))
+                return has_text;
+            if (!expect(','))
+                return false;
+        }
+    }
+};
+
+// Streams the resumes of a corpus one at a time without loading it into memory: a directory of .txt files,
+// a newline-delimited JSON file (.jsonl/.ndjson), a length-prefixed file (.lp: 4-byte little-endian length
+// followed by the text) or a single text file
+class CorpusReader
+{
+private:
+    enum Format
+    {
+        DIRECTORY,
+        JSON_LINES,
+        LENGTH_PREFIXED,
+        SINGLE_FILE
+    };
+
+    Format format;
+    vector<string> files;
+    size_t next_file = 0;
+    unique_ptr<MappedFile> mapping;
+    size_t offset = 0;
+    size_t record = 0;
+    string decoded;
+    JsonLineReader json;
+    size_t skipped = 0;
+
+public:
+    explicit CorpusReader(const string &path)
+    {
+        filesystem::path corpus(path);
+        if (filesystem::is_directory(corpus))
+        {
+            format = DIRECTORY;
+            for (const auto &entry : filesystem::directory_iterator(corpus))
+                if (entry.is_regular_file() && entry.path().extension() == ".txt")
+                    files.push_back(entry.path().string());
+            sort(files.begin(), files.end());
+            return;
+        }
+        string extension = corpus.extension().string();
+        if (extension == ".jsonl" || extension == ".ndjson")
+            format = JSON_LINES;
+        else if (extension == ".lp")
+            format = LENGTH_PREFIXED;
+        else
+            format = SINGLE_FILE;
+        mapping = make_unique<MappedFile>(path);
+        files.push_back(path);
+    }
+
+    // Lines of a JSON file that could not be parsed
+    size_t skippedRecords() const { return skipped; }
+
+    // Fetch the next resume; text stays valid until the following call
+    bool next(string &id, string_view &text)
+    {
+        if (format == DIRECTORY)
+        {
+            if (next_file == files.size())
+                return false;
+            mapping = make_unique<MappedFile>(files[next_file]);
+            id = filesystem::path(files[next_file++]).filename().string();
+            text = mapping->view();
+            return true;
+        }
+        string_view data = mapping->view();
+        if (format == SINGLE_FILE)
+        {
+            if (record++ > 0)
+                return false;
+            id = filesystem::path(files[0]).filename().string();
+            text = data;
+            return true;
+        }
+        if (format == LENGTH_PREFIXED)
+        {
+            if (offset == data.size())
+                return false;
+            if (data.size() - offset < 4)
+                throw runtime_error(files[0] + ": truncated length prefix");
+            const unsigned char *p = reinterpret_cast<const unsigned char *>(data.data() + offset);
+            size_t length = p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<size_t>(p[3]) << 24);
+            offset += 4;
+            if (data.size() - offset < length)
+                throw runtime_error(files[0] + ": truncated record " + to_string(record));
+            id = to_string(record++);
+            text = data.substr(offset, length);
+            offset += length;
+            return true;
+        }
+        while (offset < data.size())
+        {
+            size_t end = data.find('\n', offset);
+            if (end == string_view::npos)
+                end = data.size();
+            string_view line = data.substr(offset, end - offset);
+            offset = min(data.size(), end + 1);
+            size_t line_number = ++record;
+            if (trimView(line).empty())
+                continue;
+            if (!json.parse(line, id, decoded))
+            {
+                cerr << files[0] << ":" << line_number << ": skipping malformed JSON line\n";
+                skipped++;
+                continue;
+            }
+            if (id.empty())
+                id = to_string(line_number);
+            text = decoded;
+            return true;
+        }
+        return false;
+    }
+};
+
+// Append one scored resume as a single-line JSON record
+void appendResultJson(string &out, string_view id, const ResumeAnalysisResult &result)
+{
+    auto list = [&](const char *key, const vector<string> &items)
+    {
+        out.append(",\"").append(key).append("\":[");
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            if (i > 0)
+                out.push_back(',');
+            appendJsonString(out, items[i]);
+        }
+        out.push_back(']');
+    };
+    out.append("{\"id\":");
+    appendJsonString(out, id);
+    out.append(",\"ats_score\":").append(to_string(result.ats_score));
+    out.append(",\"name\":");
+    appendJsonString(out, result.personal_info.name);
+    out.append(",\"email\":");
+    appendJsonString(out, result.personal_info.email);
+    out.append(",\"phone\":");
+    appendJsonString(out, result.personal_info.phone);
+    out.append(",\"linkedin\":");
+    appendJsonString(out, result.personal_info.linkedin);
+    list("found_skills", result.keyword_match.found_skills);
+    list("missing_skills", result.keyword_match.missing_skills);
+    if (result.keyword_match.relevance >= 0)
+        out.append(",\"relevance\":").append(to_string(result.keyword_match.relevance));
+    out.append(",\"section_scores\":{");
+    bool first = true;
+    for (const auto &kv : result.section_scores)
+    {
+        if (!first)
+            out.push_back(',');
+        first = false;
+        appendJsonString(out, kv.first);
+        out.push_back(':');
+        out.append(to_string(kv.second));
+    }
+    out.push_back('}');
+    list("suggestions", result.suggestions);
+    out.append("}\n");
+}
+
+// A string of a compact result: a byte range of the record's string pool
+struct CompactString
+{
+    uint32_t offset;
+    uint32_t length;
+};
+
+// A list of a compact result: a range of the record's string table
+struct CompactList
+{
+    uint32_t first;
+    uint32_t count;
+};
+
+// Fixed-size head of a compact result. It is followed by string_count CompactStrings holding the list
+// items, then the string pool; records are padded to 8 bytes so they can be laid end to end and mmapped.
+struct CompactResult
+{
+    enum PersonalField
+    {
+        NAME,
+        EMAIL,
+        PHONE,
+        LINKEDIN,
+        GITHUB,
+        CODEFORCES,
+        PERSONAL_FIELD_COUNT
+    };
+    enum ListField
+    {
+        FOUND_SKILLS,
+        MISSING_SKILLS,
+        EDUCATION,
+        EXPERIENCE,
+        PROJECTS,
+        SKILLS,
+        SUGGESTIONS,
+        LIST_FIELD_COUNT
+    };
+
+    uint32_t record_size;
+    uint32_t string_count;
+    int32_t ats_score;
+    int32_t section_score;
+    int32_t format_score;
+    int32_t section_scores[SECTION_SCORE_COUNT];
+    int32_t relevance; // BM25 relevance to the job description, or -1 when there is none
+    uint32_t reserved;
+    double keyword_score;
+    CompactString personal[PERSONAL_FIELD_COUNT];
+    CompactList lists[LIST_FIELD_COUNT];
+};
+static_assert(sizeof(CompactResult) == 160, "CompactResult layout changed");
+
+// Append result to out in the compact encoding
+void appendCompactResult(string &out, const ResumeAnalysisResult &result)
+{
+    const PersonalInfo &info = result.personal_info;
+    const string *personal[] = {&info.name, &info.email, &info.phone, &info.linkedin, &info.github, &info.codeforces};
+    const vector<string> *lists[] = {&result.keyword_match.found_skills, &result.keyword_match.missing_skills,
+                                     &result.education, &result.experience, &result.projects, &result.skills,
+                                     &result.suggestions};
+    CompactResult head{};
+    head.ats_score = result.ats_score;
+    head.section_score = result.section_score;
+    head.format_score = result.format_score;
+    for (size_t i = 0; i < SECTION_SCORE_COUNT; i++)
+    {
+        auto it = result.section_scores.find(section_score_names[i]);
+        head.section_scores[i] = it != result.section_scores.end() ? it->second : 0;
+    }
+    head.relevance = result.keyword_match.relevance >= 0 ? result.keyword_match.relevance : -1;
+    head.keyword_score = result.keyword_match.score;
+
+    vector<CompactString> table;
+    string pool;
+    auto intern = [&](const string &s)
+    {
+        CompactString ref{static_cast<uint32_t>(pool.size()), static_cast<uint32_t>(s.size())};
+        pool += s;
+        return ref;
+    };
+    for (size_t i = 0; i < CompactResult::PERSONAL_FIELD_COUNT; i++)
+        head.personal[i] = intern(*personal[i]);
+    for (size_t i = 0; i < CompactResult::LIST_FIELD_COUNT; i++)
+    {
+        head.lists[i] = {static_cast<uint32_t>(table.size()), static_cast<uint32_t>(lists[i]->size())};
+        for (const auto &item : *lists[i])
+            table.push_back(intern(item));
+    }
+    head.string_count = static_cast<uint32_t>(table.size());
+    size_t size = sizeof(CompactResult) + table.size() * sizeof(CompactString) + pool.size();
+    head.record_size = static_cast<uint32_t>((size + 7) & ~size_t(7));
+    appendRaw(out, head);
+    out.append(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(CompactString));
+    out += pool;
+    out.append(head.record_size - size, '\0');
+}
+
+// Zero-copy access to one compact result, e.g. inside a memory-mapped file of them
+class CompactResultView
+{
+private:
+    CompactResult head;
+    const char *table;
+    string_view pool;
+
+    string_view resolve(CompactString ref) const
+    {
+        if (ref.offset > pool.size() || ref.length > pool.size() - ref.offset)
+            throw runtime_error("compact result string out of range");
+        return pool.substr(ref.offset, ref.length);
+    }
+
+public:
+    // Reads the record at the front of data; throws if it is truncated or inconsistent
+    explicit CompactResultView(string_view data)
+    {
+        if (!readRaw(data, head) || head.record_size < sizeof(CompactResult) ||
+            head.record_size - sizeof(CompactResult) > data.size() ||
+            head.string_count > (head.record_size - sizeof(CompactResult)) / sizeof(CompactString))
+            throw runtime_error("truncated compact result");
+        table = data.data();
+        size_t table_bytes = head.string_count * sizeof(CompactString);
+        pool = data.substr(table_bytes, head.record_size - sizeof(CompactResult) - table_bytes);
+        for (const auto &list : head.lists)
+            if (list.first > head.string_count || list.count > head.string_count - list.first)
+                throw runtime_error("compact result list out of range");
+    }
+
+    const CompactResult &header() const { return head; }
+    size_t recordSize() const { return head.record_size; }
+    string_view personal(CompactResult::PersonalField field) const { return resolve(head.personal[field]); }
+    size_t listSize(CompactResult::ListField field) const { return head.lists[field].count; }
+
+    string_view listItem(CompactResult::ListField field, size_t i) const
+    {
+        CompactString ref;
+        memcpy(&ref, table + (head.lists[field].first + i) * sizeof(CompactString), sizeof(ref));
+        return resolve(ref);
+    }
+
+    // Rebuild the full result
+    ResumeAnalysisResult decode() const
+    {
+        ResumeAnalysisResult result;
+        PersonalInfo &info = result.personal_info;
+        string *personal_fields[] = {&info.name, &info.email, &info.phone, &info.linkedin, &info.github, &info.codeforces};
+        for (size_t i = 0; i < CompactResult::PERSONAL_FIELD_COUNT; i++)
+            *personal_fields[i] = string(personal(static_cast<CompactResult::PersonalField>(i)));
+        vector<string> *lists[] = {&result.keyword_match.found_skills, &result.keyword_match.missing_skills,
+                                   &result.education, &result.experience, &result.projects, &result.skills,
+                                   &result.suggestions};
+        for (size_t i = 0; i < CompactResult::LIST_FIELD_COUNT; i++)
+            for (size_t k = 0; k < listSize(static_cast<CompactResult::ListField>(i)); k++)
+                lists[i]->emplace_back(listItem(static_cast<CompactResult::ListField>(i), k));
+        result.ats_score = head.ats_score;
+        result.section_score = head.section_score;
+        result.format_score = head.format_score;
+        result.keyword_match.score = head.keyword_score;
+        result.keyword_match.relevance = head.relevance;
+        for (size_t i = 0; i < SECTION_SCORE_COUNT; i++)
+            result.section_scores[section_score_names[i]] = head.section_scores[i];
+        return result;
+    }
+};
+
+// Columnar export of a scored corpus, laid out so analytics can mmap the file and read columns in place.
+// All offsets are from the start of the file and every column starts on an 8-byte boundary.
+//   ids:               uint64 offsets[resume_count + 1] into the id bytes that follow them
+//   section_score:     int16[resume_count], job-independent
+//   format_score:      int16[resume_count], job-independent
+// and per job (ColumnJob):
+//   skills:            uint64 offsets[skill_count + 1] into the skill name bytes that follow them
+//   ats_score:         int16[resume_count]
+//   section_scores:    int16[SECTION_SCORE_COUNT][resume_count]
+//   found_skills:      uint64[resume_count][words_per_resume]; bit k of a resume's words is set if job skill k was found
+struct ColumnFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t job_count;
+    uint64_t resume_count;
+    uint64_t jobs_offset; // ColumnJob[job_count]
+    uint64_t ids_offset;
+    uint64_t section_score_offset;
+    uint64_t format_score_offset;
+    uint64_t file_size;
+};
+
+struct ColumnJob
+{
+    uint32_t skill_count;
+    uint32_t words_per_resume;
+    uint32_t require_gpa;
+    uint32_t reserved;
+    uint64_t skills_offset;
+    uint64_t ats_score_offset;
+    uint64_t section_scores_offset;
+    uint64_t found_skills_offset;
+};
+
+const char column_file_magic[8] = {'A', 'T', 'S', 'C', 'O', 'L', 'S', '1'};
+
+// Builds a columnar export in memory one batch of results at a time, then writes it out
+class ColumnWriter
+{
+private:
+    struct JobColumns
+    {
+        vector<string> skills;
+        bool require_gpa;
+        size_t words;
+        vector<int16_t> ats_score;
+        vector<int16_t> section_scores[SECTION_SCORE_COUNT];
+        vector<uint64_t> found_skills;
+    };
+
+    vector<JobColumns> jobs;
+    vector<uint64_t> id_offsets{0};
+    string id_bytes;
+    vector<int16_t> section_score, format_score;
+
+    static void pad(string &out)
+    {
+        out.append((8 - out.size() % 8) % 8, '\0');
+    }
+
+    template <typename T>
+    static uint64_t appendColumn(string &out, const vector<T> &column)
+    {
+        pad(out);
+        uint64_t offset = out.size();
+        out.append(reinterpret_cast<const char *>(column.data()), column.size() * sizeof(T));
+        return offset;
+    }
+
+    static uint64_t appendStrings(string &out, const vector<uint64_t> &offsets, string_view bytes)
+    {
+        uint64_t offset = appendColumn(out, offsets);
+        out.append(bytes);
+        return offset;
+    }
+
+public:
+    explicit ColumnWriter(const vector<JobRequirements> &job_list)
+    {
+        for (const auto &job : job_list)
+            jobs.push_back({job.required_skills, job.require_gpa, (job.required_skills.size() + 63) / 64, {}, {}, {}});
+    }
+
+    // Add one resume's scores against the batch jobs, which are the writer's jobs in the same order
+    void add(string_view id, const BatchRow &row, const BatchJobs &batch)
+    {
+        id_bytes.append(id);
+        id_offsets.push_back(id_bytes.size());
+        section_score.push_back(static_cast<int16_t>(jobs.empty() ? 0 : row.section_score));
+        format_score.push_back(static_cast<int16_t>(jobs.empty() ? 0 : row.format_score));
+        for (size_t j = 0; j < jobs.size(); j++)
+        {
+            JobColumns &job = jobs[j];
+            job.ats_score.push_back(static_cast<int16_t>(row.ats_scores[j]));
+            for (size_t s = 0; s < SECTION_SCORE_COUNT; s++)
+                job.section_scores[s].push_back(static_cast<int16_t>(row.section_scores[j][s]));
+            // Bit k of found_skills is set when the job's k-th skill was found
+            size_t base = job.found_skills.size();
+            job.found_skills.resize(base + job.words);
+            for (size_t k = 0; k < job.skills.size(); k++)
+                if (batch.skills[j].found(row.found, k))
+                    job.found_skills[base + k / 64] |= 1ull << (k % 64);
+        }
+    }
+
+    size_t size() const { return section_score.size(); }
+
+    string finish() const
+    {
+        string out(sizeof(ColumnFileHeader) + jobs.size() * sizeof(ColumnJob), '\0');
+        ColumnFileHeader header{};
+        memcpy(header.magic, column_file_magic, sizeof(header.magic));
+        header.version = 1;
+        header.job_count = static_cast<uint32_t>(jobs.size());
+        header.resume_count = size();
+        header.jobs_offset = sizeof(ColumnFileHeader);
+        header.ids_offset = appendStrings(out, id_offsets, id_bytes);
+        header.section_score_offset = appendColumn(out, section_score);
+        header.format_score_offset = appendColumn(out, format_score);
+        for (size_t j = 0; j < jobs.size(); j++)
+        {
+            const JobColumns &job = jobs[j];
+            ColumnJob entry{};
+            entry.skill_count = static_cast<uint32_t>(job.skills.size());
+            entry.words_per_resume = static_cast<uint32_t>(job.words);
+            entry.require_gpa = job.require_gpa;
+            vector<uint64_t> skill_offsets{0};
+            string skill_bytes;
+            for (const auto &skill : job.skills)
+            {
+                skill_bytes += skill;
+                skill_offsets.push_back(skill_bytes.size());
+            }
+            entry.skills_offset = appendStrings(out, skill_offsets, skill_bytes);
+            entry.ats_score_offset = appendColumn(out, job.ats_score);
+            entry.section_scores_offset = appendColumn(out, job.section_scores[0]);
+            for (size_t s = 1; s < SECTION_SCORE_COUNT; s++)
+                out.append(reinterpret_cast<const char *>(job.section_scores[s].data()), size() * sizeof(int16_t));
+            entry.found_skills_offset = appendColumn(out, job.found_skills);
+            memcpy(&out[sizeof(ColumnFileHeader) + j * sizeof(ColumnJob)], &entry, sizeof(entry));
+        }
+        pad(out);
+        header.file_size = out.size();
+        memcpy(&out[0], &header, sizeof(header));
+        return out;
+    }
+};
+
+// Read-only view of a columnar export; columns are pointers into the mapping, nothing is parsed or copied
+class ColumnFile
+{
+private:
+    MappedFile file;
+    ColumnFileHeader header{};
+    vector<ColumnJob> jobs;
+
+    template <typename T>
+    const T *column(uint64_t offset, uint64_t count) const
+    {
+        string_view data = file.view();
+        if (offset % alignof(T) != 0 || offset > data.size() || count > (data.size() - offset) / sizeof(T))
+            throw runtime_error("column out of range");
+        return reinterpret_cast<const T *>(data.data() + offset);
+    }
+
+    string_view stringAt(uint64_t offsets_at, uint64_t count, size_t i) const
+    {
+        const uint64_t *offsets = column<uint64_t>(offsets_at, count + 1);
+        uint64_t bytes_at = offsets_at + (count + 1) * sizeof(uint64_t);
+        const char *bytes = column<char>(bytes_at, offsets[count]);
+        if (offsets[i] > offsets[i + 1] || offsets[i + 1] > offsets[count])
+            throw runtime_error("string table out of range");
+        return string_view(bytes + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+
+public:
+    explicit ColumnFile(const string &path) : file(path)
+    {
+        string_view data = file.view();
+        if (!readRaw(data, header) || memcmp(header.magic, column_file_magic, sizeof(header.magic)) != 0 ||
+            header.version != 1 || header.file_size != file.view().size())
+            throw runtime_error(path + ": not a column export");
+        const ColumnJob *entries = column<ColumnJob>(header.jobs_offset, header.job_count);
+        jobs.assign(entries, entries + header.job_count);
+    }
+
+    size_t resumeCount() const { return header.resume_count; }
+    size_t jobCount() const { return jobs.size(); }
+    const ColumnJob &job(size_t j) const { return jobs[j]; }
+    string_view id(size_t i) const { return stringAt(header.ids_offset, header.resume_count, i); }
+    string_view skill(size_t j, size_t k) const { return stringAt(jobs[j].skills_offset, jobs[j].skill_count, k); }
+    const int16_t *sectionScore() const { return column<int16_t>(header.section_score_offset, header.resume_count); }
+    const int16_t *formatScore() const { return column<int16_t>(header.format_score_offset, header.resume_count); }
+    const int16_t *atsScore(size_t j) const { return column<int16_t>(jobs[j].ats_score_offset, header.resume_count); }
+
+    const int16_t *sectionScores(size_t j, SectionScore section) const
+    {
+        return column<int16_t>(jobs[j].section_scores_offset, SECTION_SCORE_COUNT * header.resume_count) +
+               section * header.resume_count;
+    }
+
+    const uint64_t *foundSkills(size_t j, size_t i) const
+    {
+        return column<uint64_t>(jobs[j].found_skills_offset, header.resume_count * jobs[j].words_per_resume) +
+               i * jobs[j].words_per_resume;
+    }
+
+    bool found(size_t j, size_t i, size_t k) const { return (foundSkills(j, i)[k / 64] >> (k % 64)) & 1; }
+};
+
+// CRC-32C (Castagnoli) lookup table, built at compile time
+constexpr array<uint32_t, 256> crc32cTable()
+{
+    array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (crc & 1 ? 0x82F63B78u : 0);
+        table[i] = crc;
+    }
+    return table;
+}
+
+// Continue the CRC-32C crc (0 to start) over data
+uint32_t crc32c(uint32_t crc, string_view data)
+{
+    static constexpr array<uint32_t, 256> table = crc32cTable();
+    crc = ~crc;
+    for (char c : data)
+        crc = table[(crc ^ static_cast<unsigned char>(c)) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// Fixed-size head of a job-independent analysis in an AnalysisStore, followed like a CompactResult by
+// string_count CompactStrings holding the section entries and then the string pool
+struct StoredAnalysis
+{
+    enum SectionField
+    {
+        EDUCATION,
+        EXPERIENCE,
+        PROJECTS,
+        SECTION_FIELD_COUNT
+    };
+
+    uint32_t string_count;
+    int32_t section_score;
+    int32_t format_score;
+    uint32_t format_issues;
+    uint32_t entry_flags; // the entry checks, in serializeAnalysis order
+    uint32_t reserved;
+    CompactString personal[CompactResult::PERSONAL_FIELD_COUNT];
+    CompactList sections[SECTION_FIELD_COUNT];
+};
+static_assert(sizeof(StoredAnalysis) == 96, "StoredAnalysis layout changed");
+
+// Append analysis to out as a StoredAnalysis, padded to 8 bytes
+void appendStoredAnalysis(string &out, const DocumentAnalysis &analysis)
+{
+    const PersonalInfo &info = analysis.personal_info;
+    const string *personal[] = {&info.name, &info.email, &info.phone, &info.linkedin, &info.github, &info.codeforces};
+    const vector<string> *sections[] = {&analysis.education, &analysis.experience, &analysis.projects};
+    StoredAnalysis head{};
+    head.section_score = analysis.section_score;
+    head.format_score = analysis.format.score;
+    head.format_issues = analysis.format.issues;
+    head.entry_flags = analysis.experience_has_dates | analysis.experience_has_bullets << 1 |
+                       analysis.experience_has_action_verbs << 2 | analysis.education_has_dates << 3 |
+                       analysis.education_has_degree << 4 | analysis.education_has_gpa << 5;
+    vector<CompactString> table;
+    string pool;
+    auto intern = [&](const string &s)
+    {
+        CompactString ref{static_cast<uint32_t>(pool.size()), static_cast<uint32_t>(s.size())};
+        pool += s;
+        return ref;
+    };
+    for (size_t i = 0; i < CompactResult::PERSONAL_FIELD_COUNT; i++)
+        head.personal[i] = intern(*personal[i]);
+    for (size_t i = 0; i < StoredAnalysis::SECTION_FIELD_COUNT; i++)
+    {
+        head.sections[i] = {static_cast<uint32_t>(table.size()), static_cast<uint32_t>(sections[i]->size())};
+        for (const auto &entry : *sections[i])
+            table.push_back(intern(entry));
+    }
+    head.string_count = static_cast<uint32_t>(table.size());
+    size_t start = out.size();
+    appendRaw(out, head);
+    out.append(reinterpret_cast<const char *>(table.data()), table.size() * sizeof(CompactString));
+    out += pool;
+    out.append((8 - (out.size() - start) % 8) % 8, '\0');
+}
+
+// Zero-copy access to a StoredAnalysis, e.g. inside a memory-mapped AnalysisStore
+class StoredAnalysisView
+{
+private:
+    StoredAnalysis head;
+    const char *table;
+    string_view pool;
+
+    string_view resolve(CompactString ref) const
+    {
+        if (ref.offset > pool.size() || ref.length > pool.size() - ref.offset)
+            throw runtime_error("stored analysis string out of range");
+        return pool.substr(ref.offset, ref.length);
+    }
+
+public:
+    // Reads the analysis filling data; throws if it is truncated or inconsistent
+    explicit StoredAnalysisView(string_view data)
+    {
+        if (!readRaw(data, head) || head.string_count > data.size() / sizeof(CompactString))
+            throw runtime_error("truncated stored analysis");
+        table = data.data();
+        pool = data.substr(head.string_count * sizeof(CompactString));
+        for (const auto &section : head.sections)
+            if (section.first > head.string_count || section.count > head.string_count - section.first)
+                throw runtime_error("stored analysis section out of range");
+    }
+
+    const StoredAnalysis &header() const { return head; }
+    string_view personal(CompactResult::PersonalField field) const { return resolve(head.personal[field]); }
+    size_t sectionSize(StoredAnalysis::SectionField field) const { return head.sections[field].count; }
+
+    string_view sectionEntry(StoredAnalysis::SectionField field, size_t i) const
+    {
+        CompactString ref;
+        memcpy(&ref, table + (head.sections[field].first + i) * sizeof(CompactString), sizeof(ref));
+        return resolve(ref);
+    }
+
+    // Rebuild the full analysis
+    DocumentAnalysis decode() const
+    {
+        DocumentAnalysis analysis;
+        PersonalInfo &info = analysis.personal_info;
+        string *personal_fields[] = {&info.name, &info.email, &info.phone, &info.linkedin, &info.github, &info.codeforces};
+        for (size_t i = 0; i < CompactResult::PERSONAL_FIELD_COUNT; i++)
+            *personal_fields[i] = string(personal(static_cast<CompactResult::PersonalField>(i)));
+        vector<string> *sections[] = {&analysis.education, &analysis.experience, &analysis.projects};
+        for (size_t i = 0; i < StoredAnalysis::SECTION_FIELD_COUNT; i++)
+            for (size_t k = 0; k < sectionSize(static_cast<StoredAnalysis::SectionField>(i)); k++)
+                sections[i]->emplace_back(sectionEntry(static_cast<StoredAnalysis::SectionField>(i), k));
+        analysis.section_score = head.section_score;
+        analysis.format = FormatCheck{head.format_score, head.format_issues};
+        analysis.experience_has_dates = head.entry_flags & 1;
+        analysis.experience_has_bullets = head.entry_flags & 2;
+        analysis.experience_has_action_verbs = head.entry_flags & 4;
+        analysis.education_has_dates = head.entry_flags & 8;
+        analysis.education_has_degree = head.entry_flags & 16;
+        analysis.education_has_gpa = head.entry_flags & 32;
+        return analysis;
+    }
+};
+
+// Head of an AnalysisStore file
+struct StoreFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+};
+
+// Head of one AnalysisStore record. It is followed by the id, zero padding to 8 bytes, and a
+// StoredAnalysis of payload_size bytes. checksum is the CRC-32C of the whole record with checksum
+// itself zeroed, so a record cut short by a crash, or never completely written, is recognized.
+struct StoreRecordHeader
+{
+    uint32_t magic;
+    uint32_t checksum;
+    uint32_t id_size;
+    uint32_t payload_size;
+    uint64_t content_hash;  // ContentKey of the resume text
+    uint64_t content_check;
+    uint64_t text_size;
+};
+static_assert(sizeof(StoreRecordHeader) == 40, "StoreRecordHeader layout changed");
+
+// Append-only file of analyzed resumes, mmapped so a restarted process can look resumes up by id or by
+// content in place instead of analyzing the corpus again. A record for an id that is already stored
+// supersedes the earlier one. Opening the store walks the record headers once to index them; a torn
+// record at the end, left by a crash during an append, ends the valid part of the file and is cut off.
+// An invalid record with intact records after it is corruption, and the store refuses to open.
+// One process at a time may open a store for writing.
+class AnalysisStore
+{
+public:
+    struct Stats
+    {
+        size_t records = 0;
+        size_t live_records = 0;   // the latest record of each id
+        size_t file_bytes = 0;
+        size_t truncated_bytes = 0; // torn tail removed when the store was opened
+    };
+
+private:
+    static constexpr char file_magic[8] = {'A', 'T', 'S', 'S', 'T', 'O', 'R', 'E'};
+    static constexpr uint32_t record_magic = 0x52535441; // "ATSR"
+
+    string file_path;
+    int fd = -1;
+    const char *data = nullptr;
+    size_t mapped = 0;
+    size_t file_size = 0;
+    unordered_map<string, uint64_t> by_id; // offset of the latest record of each id
+    unordered_map<ContentKey, uint64_t, ContentKeyHash> by_content; // offset of the latest record of each text
+    Stats counters;
+
+    static size_t padded(size_t size) { return (size + 7) & ~size_t(7); }
+
+    // Map at least size bytes; the mapping may extend past the end of the file and is only read below file_size
+    void mapAtLeast(size_t size)
+    {
+        if (size <= mapped)
+            return;
+        size_t length = max(size, max(mapped * 2, size_t(1) << 20));
+        void *mapping = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED)
+            throw runtime_error(file_path + ": " + strerror(errno));
+        if (data)
+            munmap(const_cast<char *>(data), mapped);
+        data = static_cast<const char *>(mapping);
+        mapped = length;
+    }
+
+    // The record at offset, or nullopt if it is torn or corrupt
+    optional<StoreRecordHeader> readRecord(uint64_t offset) const
+    {
+        StoreRecordHeader header;
+        if (file_size - offset < sizeof(header))
+            return nullopt;
+        memcpy(&header, data + offset, sizeof(header));
+        if (header.magic != record_magic || header.payload_size % 8 != 0 ||
+            header.payload_size < sizeof(StoredAnalysis) ||
+            padded(header.id_size) + header.payload_size > file_size - offset - sizeof(header))
+            return nullopt;
+        StoreRecordHeader unsigned_header = header;
+        unsigned_header.checksum = 0;
+        uint32_t crc = crc32c(0, string_view(reinterpret_cast<const char *>(&unsigned_header), sizeof(header)));
+        crc = crc32c(crc, string_view(data + offset + sizeof(header), padded(header.id_size) + header.payload_size));
+        if (crc != header.checksum)
+            return nullopt;
+        return header;
+    }
+
+    // True if the invalid record at offset can only be an append cut short by a crash: it claims to run
+    // to the end of the file or past it, or nothing but zeros (space allocated but never written) follows
+    bool tornAt(uint64_t offset) const
+    {
+        size_t remaining = file_size - offset;
+        StoreRecordHeader header;
+        if (remaining < sizeof(header))
+            return true;
+        memcpy(&header, data + offset, sizeof(header));
+        if (header.magic == record_magic && sizeof(header) + padded(header.id_size) + header.payload_size >= remaining)
+            return true;
+        return all_of(data + offset, data + file_size, [](char c)
+                      { return c == 0; });
+    }
+
+    // Make a new or renamed directory entry of path durable
+    static void syncDirectory(const string &path)
+    {
+        string directory = filesystem::path(path).parent_path().string();
+        int dir_fd = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY);
+        if (dir_fd < 0)
+            throw runtime_error(directory + ": " + strerror(errno));
+        int status = fsync(dir_fd);
+        close(dir_fd);
+        if (status != 0)
+            throw runtime_error(directory + ": " + strerror(errno));
+    }
+
+    // Write a complete record at the end of the file and index it
+    void writeRecord(string_view record, const StoreRecordHeader &header)
+    {
+        for (size_t written = 0; written < record.size();)
+        {
+            ssize_t n = pwrite(fd, record.data() + written, record.size() - written, file_size + written);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                throw runtime_error(file_path + ": " + strerror(errno));
+            written += n;
+        }
+        uint64_t offset = file_size;
+        file_size += record.size();
+        mapAtLeast(file_size);
+        index(offset, header);
+    }
+
+    void index(uint64_t offset, const StoreRecordHeader &header)
+    {
+        string id(data + offset + sizeof(header), header.id_size);
+        if (by_id.insert_or_assign(move(id), offset).second)
+            counters.live_records++;
+        by_content[{header.content_hash, header.content_check, header.text_size}] = offset;
+        counters.records++;
+    }
+
+public:
+    // Open or create the store at path. A writable store has its torn tail, if any, truncated; a store
+    // with a corrupt record before its end throws.
+    explicit AnalysisStore(const string &path, bool writable = true) : file_path(path)
+    {
+        fd = open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+        if (fd < 0)
+            throw runtime_error(path + ": " + strerror(errno));
+        if (writable && flock(fd, LOCK_EX | LOCK_NB) != 0)
+        {
+            close(fd);
+            throw runtime_error(path + ": already open for writing in another process");
+        }
+        try
+        {
+            struct stat info;
+            if (fstat(fd, &info) != 0)
+                throw runtime_error(path + ": " + strerror(errno));
+            file_size = static_cast<size_t>(info.st_size);
+            if (file_size == 0 && writable)
+            {
+                StoreFileHeader header{};
+                memcpy(header.magic, file_magic, sizeof(file_magic));
+                header.version = 2;
+                if (pwrite(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) || fsync(fd) != 0)
+                    throw runtime_error(path + ": " + strerror(errno));
+                syncDirectory(path);
+                file_size = sizeof(header);
+            }
+            StoreFileHeader header;
+            if (file_size < sizeof(header) || pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+                memcmp(header.magic, file_magic, sizeof(file_magic)) != 0 || header.version != 2)
+                throw runtime_error(path + ": not an analysis store");
+            mapAtLeast(file_size);
+            uint64_t offset = sizeof(header);
+            while (auto record = readRecord(offset))
+            {
+                index(offset, *record);
+                offset += sizeof(StoreRecordHeader) + padded(record->id_size) + record->payload_size;
+            }
+            if (offset < file_size && !tornAt(offset))
+                throw runtime_error(path + ": corrupt record at offset " + to_string(offset) + ", " +
+                                    to_string(file_size - offset) + " bytes before the end of the file");
+            counters.truncated_bytes = file_size - offset;
+            if (offset < file_size && writable)
+            {
+                if (ftruncate(fd, offset) != 0 || fsync(fd) != 0)
+                    throw runtime_error(path + ": " + strerror(errno));
+                file_size = offset;
+            }
+        }
+        catch (...)
+        {
+            if (data)
+                munmap(const_cast<char *>(data), mapped);
+            close(fd);
+            throw;
+        }
+    }
+
+    ~AnalysisStore()
+    {
+        if (data)
+            munmap(const_cast<char *>(data), mapped);
+        close(fd);
+    }
+
+    AnalysisStore(const AnalysisStore &) = delete;
+    AnalysisStore &operator=(const AnalysisStore &) = delete;
+
+    // The latest analysis stored for id, valid until the next append
+    optional<StoredAnalysisView> findId(const string &id) const
+    {
+        auto it = by_id.find(id);
+        if (it == by_id.end())
+            return nullopt;
+        return payloadAt(it->second);
+    }
+
+    // The latest analysis stored for a text with this key, valid until the next append
+    optional<StoredAnalysisView> findContent(const ContentKey &key) const
+    {
+        auto it = by_content.find(key);
+        if (it == by_content.end())
+            return nullopt;
+        return payloadAt(it->second);
+    }
+
+    StoredAnalysisView payloadAt(uint64_t offset) const
+    {
+        StoreRecordHeader header;
+        memcpy(&header, data + offset, sizeof(header));
+        return StoredAnalysisView(
+            string_view(data + offset + sizeof(header) + padded(header.id_size), header.payload_size));
+    }
+
+    // Append the analysis of the resume with this id and text. The record goes to the file in one write;
+    // call sync() to make appends durable.
+    void append(string_view id, string_view text, const DocumentAnalysis &analysis)
+    {
+        string record(sizeof(StoreRecordHeader), '\0');
+        record += id;
+        record.append(padded(id.size()) - id.size(), '\0');
+        size_t payload_start = record.size();
+        appendStoredAnalysis(record, analysis);
+        ContentKey key = ContentKey::of(text);
+        StoreRecordHeader header{record_magic, 0, static_cast<uint32_t>(id.size()),
+                                 static_cast<uint32_t>(record.size() - payload_start), key.hash, key.check, key.length};
+        memcpy(record.data(), &header, sizeof(header));
+        header.checksum = crc32c(0, record);
+        memcpy(record.data(), &header, sizeof(header));
+        writeRecord(record, header);
+    }
+
+    // Flush appended records to stable storage
+    void sync()
+    {
+        if (fdatasync(fd) != 0)
+            throw runtime_error(file_path + ": " + strerror(errno));
+    }
+
+    Stats stats() const
+    {
+        Stats result = counters;
+        result.file_bytes = file_size;
+        return result;
+    }
+
+    // Call visit(id, view) for the latest record of every id, in file order
+    template <typename Visit>
+    void forEachLive(Visit visit) const
+    {
+        for (uint64_t offset : liveOffsets())
+        {
+            StoreRecordHeader header;
+            memcpy(&header, data + offset, sizeof(header));
+            visit(string_view(data + offset + sizeof(header), header.id_size), payloadAt(offset));
+        }
+    }
+
+    // Rewrite the store at path keeping only the latest record of each id. The compacted copy is
+    // written and synced beside it, then renamed over it and the rename synced, so a crash leaves one of
+    // the two intact.
+    static Stats compact(const string &path)
+    {
+        string temp_path = path + ".compact";
+        filesystem::remove(temp_path);
+        AnalysisStore source(path);
+        AnalysisStore target(temp_path);
+        for (uint64_t offset : source.liveOffsets())
+        {
+            StoreRecordHeader header;
+            memcpy(&header, source.data + offset, sizeof(header));
+            size_t size = sizeof(header) + padded(header.id_size) + header.payload_size;
+            target.writeRecord(string_view(source.data + offset, size), header);
+        }
+        target.sync();
+        filesystem::rename(temp_path, path);
+        syncDirectory(path);
+        return target.stats();
+    }
+
+private:
+    vector<uint64_t> liveOffsets() const
+    {
+        vector<uint64_t> offsets;
+        offsets.reserve(by_id.size());
+        for (const auto &entry : by_id)
+            offsets.push_back(entry.second);
+        sort(offsets.begin(), offsets.end());
+        return offsets;
+    }
+};
+
+// Append one entry of a binary stream: u32 id length, the id, zero padding to 8 bytes, then the compact result
+void appendCompactEntry(string &out, string_view id, const ResumeAnalysisResult &result)
+{
+    appendLengthPrefixed(out, id);
+    out.append((8 - (sizeof(uint32_t) + id.size()) % 8) % 8, '\0');
+    appendCompactResult(out, result);
+}
+
+// Score every resume of a corpus as it is read, writing one JSON record (or with binary, one compact entry)
+// per resume to stdout. With a cache, resubmitted resumes reuse their job-independent analysis; with a
+// near-duplicate index, so do lightly edited copies of a resume seen earlier. With a store, resumes
+// analyzed by any earlier run are read back from it and new ones are appended (a resume whose text is
+// already stored is not stored again under another id). Resumes of ResumeAnalyzer::parallel_analysis_bytes
+// or more are analyzed in chunks on a pool started for the first of them.
+int runStream(const string &path, const JobRequirements &job, AnalysisCache *cache, NearDuplicateIndex *dedup,
+              const string &store_path, bool binary)
+{
+    ResumeAnalyzer analyzer;
+    auto relevance_corpus = make_shared<RelevanceCorpus>();
+    JobProfile profile(job, relevance_corpus);
+    size_t documents = 0, bytes = 0, stored = 0;
+    string id, record;
+    string_view text;
+    auto start = chrono::steady_clock::now();
+    unique_ptr<AnalysisStore> store;
+    unique_ptr<WorkStealingPool> pool;
+    auto large = [&](string_view text)
+    {
+        if (text.size() < ResumeAnalyzer::parallel_analysis_bytes)
+            return false;
+        if (!pool)
+            pool = make_unique<WorkStealingPool>();
+        return pool->size() > 1;
+    };
+    try
+    {
+        if (!store_path.empty())
+            store = make_unique<AnalysisStore>(store_path);
+        CorpusReader reader(path);
+        while (reader.next(id, text))
+        {
+            // The idf statistics grow with the stream: each resume is scored against all resumes so far
+            if (profile.relevance())
+                relevance_corpus->addDocument(text);
+            ResumeAnalysisResult result;
+            if (store)
+            {
+                optional<StoredAnalysisView> found = store->findContent(ContentKey::of(text));
+                if (found)
+                {
+                    result = analyzer.scoreDocument(found->decode(), text, profile);
+                    stored++;
+                }
+                else
+                {
+                    DocumentAnalysis analysis = large(text) ? analyzer.analyzeDocument(text, *pool)
+                                                            : analyzer.analyzeDocument(text);
+                    store->append(id, text, analysis);
+                    result = analyzer.scoreDocument(move(analysis), text, profile);
+                }
+            }
+            else
+                result = dedup   ? analyzer.analyzeResume(text, profile, *dedup)
+                         : cache ? analyzer.analyzeResume(text, profile, *cache)
+                         : large(text) ? analyzer.analyzeResume(text, profile, *pool)
+                                       : analyzer.analyzeResume(text, profile);
+            record.clear();
+            if (binary)
+                appendCompactEntry(record, id, result);
+            else
+                appendResultJson(record, id, result);
+            cout.write(record.data(), record.size());
+            documents++;
+            bytes += text.size();
+        }
+        if (store)
+            store->sync();
+        if (reader.skippedRecords() > 0)
+            cerr << "Skipped " << reader.skippedRecords() << " malformed record(s)\n";
+    }
+    catch (const exception &e)
+    {
+        cout.flush();
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    cout.flush();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    double seconds = max(elapsed.count(), 1e-9);
+    cerr << "Scored " << documents << " resume(s), " << bytes / 1e6 << " MB in " << elapsed.count() << " s: "
+         << documents / seconds << " docs/s, " << bytes / 1e6 / seconds << " MB/s\n";
+    if (cache)
+    {
+        AnalysisCache::Stats stats = cache->stats();
+        cerr << "Cache: " << stats.hits << " hits, " << stats.disk_hits << " disk hits, " << stats.misses
+             << " misses, " << stats.evictions << " evictions\n";
+        if (stats.spill_failures > 0)
+            cerr << "Cache: " << stats.spill_failures << " evicted analyses could not be spilled and were dropped\n";
+    }
+    if (dedup)
+    {
+        NearDuplicateIndex::Stats stats = dedup->stats();
+        cerr << "Near-duplicates: " << stats.reused << " reused the analysis of one of " << stats.representatives
+             << " representatives (" << stats.evicted << " evicted), " << stats.comparisons
+             << " signature comparisons, " << stats.truncated_walks << " truncated bucket walks\n";
+    }
+    if (store)
+    {
+        AnalysisStore::Stats stats = store->stats();
+        cerr << "Store: " << stored << " resume(s) read back, " << documents - stored << " analyzed and appended; "
+             << stats.live_records << " stored resume(s), " << stats.file_bytes << " bytes\n";
+        if (stats.truncated_bytes > 0)
+            cerr << "Store: cut off " << stats.truncated_bytes << " bytes of an incomplete append\n";
+    }
+    return 0;
+}
+
+// Print the stored analysis of one resume as JSON
+int runStoreGet(const string &path, const string &id)
+{
+    try
+    {
+        AnalysisStore store(path, false);
+        optional<StoredAnalysisView> found = store.findId(id);
+        if (!found)
+        {
+            cerr << "No resume " << id << " in " << path << "\n";
+            return 1;
+        }
+        const StoredAnalysis &head = found->header();
+        string out = "{\"id\": ";
+        appendJsonString(out, id);
+        const char *personal_names[] = {"name", "email", "phone", "linkedin", "github", "codeforces"};
+        for (size_t i = 0; i < CompactResult::PERSONAL_FIELD_COUNT; i++)
+        {
+            out += ", \"" + string(personal_names[i]) + "\": ";
+            appendJsonString(out, found->personal(static_cast<CompactResult::PersonalField>(i)));
+        }
+        out += ", \"section_score\": " + to_string(head.section_score) + ", \"format_score\": " +
+               to_string(head.format_score);
+        const char *section_names[] = {"education", "experience", "projects"};
+        for (size_t i = 0; i < StoredAnalysis::SECTION_FIELD_COUNT; i++)
+        {
+            auto field = static_cast<StoredAnalysis::SectionField>(i);
+            out += ", \"" + string(section_names[i]) + "\": [";
+            for (size_t k = 0; k < found->sectionSize(field); k++)
+            {
+                if (k > 0)
+                    out += ", ";
+                appendJsonString(out, found->sectionEntry(field, k));
+            }
+            out += "]";
+        }
+        out += "}\n";
+        cout << out;
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Drop superseded records from a store
+int runStoreCompact(const string &path)
+{
+    try
+    {
+        size_t before = AnalysisStore(path).stats().file_bytes;
+        AnalysisStore::Stats after = AnalysisStore::compact(path);
+        cerr << "Compacted " << path << ": " << before << " -> " << after.file_bytes << " bytes, "
+             << after.live_records << " resume(s)\n";
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Peak resident set size of the process so far, in megabytes
+double peakMemoryMegabytes()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+// One resume on its way through the ingestion pipeline; each stage fills in the next field and drops
+// what later stages no longer need
+struct PipelineItem
+{
+    size_t index;
+    string id;
+    string text;
+    size_t bytes = 0;
+    int relevance = KeywordMatchResult::unscored;
+    optional<ResumeText> doc;
+    DocumentAnalysis analysis;
+    ResumeAnalysisResult result;
+    string record;
+};
+
+using PipelineQueue = BoundedQueue<unique_ptr<PipelineItem>>;
+
+// Counters of one pipeline stage, summed over its workers
+struct PipelineStage
+{
+    const char *name;
+    size_t workers = 1;
+    atomic<uint64_t> items{0};
+    atomic<uint64_t> busy_ns{0};
+    atomic<uint64_t> starved_ns{0}; // waiting for input
+    atomic<uint64_t> blocked_ns{0}; // waiting for room in the next queue
+
+    // Add one worker's totals
+    void add(uint64_t count, uint64_t busy, uint64_t starved, uint64_t blocked)
+    {
+        items += count;
+        busy_ns += busy;
+        starved_ns += starved;
+        blocked_ns += blocked;
+    }
+};
+
+// Start stage.workers threads that move items from in to out through body(item); the last of them to
+// run out of input closes out
+template <typename Body>
+void startPipelineStage(vector<thread> &threads, PipelineStage &stage, PipelineQueue &in, PipelineQueue &out, Body body)
+{
+    auto remaining = make_shared<atomic<size_t>>(stage.workers);
+    for (size_t w = 0; w < stage.workers; w++)
+        threads.emplace_back([&stage, &in, &out, body, remaining]
+                             {
+                                 auto nanos = [](chrono::steady_clock::time_point from, chrono::steady_clock::time_point to)
+                                 { return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(to - from).count()); };
+                                 uint64_t count = 0, busy = 0, starved = 0, blocked = 0;
+                                 unique_ptr<PipelineItem> item;
+                                 auto last = chrono::steady_clock::now();
+                                 while (in.pop(item))
+                                 {
+                                     auto popped = chrono::steady_clock::now();
+                                     body(*item);
+                                     auto done = chrono::steady_clock::now();
+                                     out.push(move(item));
+                                     auto pushed = chrono::steady_clock::now();
+                                     starved += nanos(last, popped);
+                                     busy += nanos(popped, done);
+                                     blocked += nanos(done, pushed);
+                                     count++;
+                                     last = pushed;
+                                 }
+                                 starved += nanos(last, chrono::steady_clock::now());
+                                 stage.add(count, busy, starved, blocked);
+                                 if (remaining->fetch_sub(1) == 1)
+                                     out.close(); });
+}
+
+// Score a corpus like runStream, as a pipeline of stages on their own threads: read -> normalize
+// (lowercase copy and line table) -> segment (the job-independent analysis) -> score -> serialize ->
+// write. Stages are joined by bounded queues and at most in_flight resumes are between reading and
+// writing, so a slow writer holds the reader back and memory stays bounded. Records come out in input
+// order; per-stage throughput and queue depths are reported on stderr. write_delay_us slows the
+// writer down, to watch the backpressure.
+int runPipeline(const string &path, const JobRequirements &job, size_t workers, size_t queue_capacity, bool binary,
+                size_t write_delay_us)
+{
+    ResumeAnalyzer analyzer;
+    auto relevance_corpus = make_shared<RelevanceCorpus>();
+    JobProfile profile(job, relevance_corpus);
+    workers = max<size_t>(workers, 1);
+    PipelineStage read{"read"}, normalize{"normalize", workers}, segment{"segment", workers}, score{"score", workers},
+        serialize{"serialize", workers}, write{"write"};
+    PipelineStage *stages[] = {&read, &normalize, &segment, &score, &serialize, &write};
+    PipelineQueue read_queue(queue_capacity), normalized_queue(queue_capacity), segmented_queue(queue_capacity),
+        scored_queue(queue_capacity), serialized_queue(queue_capacity);
+    PipelineQueue *queues[] = {&read_queue, &normalized_queue, &segmented_queue, &scored_queue, &serialized_queue};
+    const size_t in_flight_limit = size(queues) * read_queue.capacity();
+    size_t in_flight = 0;
+    mutex flight_lock;
+    condition_variable flight_room;
+    string error;
+    size_t skipped = 0;
+    auto start = chrono::steady_clock::now();
+    auto since = [](chrono::steady_clock::time_point from)
+    { return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - from).count()); };
+
+    vector<thread> threads;
+    threads.emplace_back([&]
+                         {
+                             uint64_t count = 0, busy = 0, blocked = 0;
+                             try
+                             {
+                                 CorpusReader reader(path);
+                                 string id;
+                                 string_view text;
+                                 auto last = chrono::steady_clock::now();
+                                 while (reader.next(id, text))
+                                 {
+                                     auto item = make_unique<PipelineItem>();
+                                     item->index = count++;
+                                     item->id = id;
+                                     item->text = string(text);
+                                     item->bytes = text.size();
+                                     // Relevance is scored here, in input order, so that like in runStream
+                                     // the idf statistics cover exactly the resumes up to this one
+                                     if (profile.relevance())
+                                     {
+                                         relevance_corpus->addDocument(item->text);
+                                         item->relevance = profile.relevance()->score(item->text);
+                                     }
+                                     busy += since(last);
+                                     auto waiting = chrono::steady_clock::now();
+                                     {
+                                         unique_lock<mutex> guard(flight_lock);
+                                         flight_room.wait(guard, [&]
+                                                          { return in_flight < in_flight_limit; });
+                                         in_flight++;
+                                     }
+                                     read_queue.push(move(item));
+                                     blocked += since(waiting);
+                                     last = chrono::steady_clock::now();
+                                 }
+                                 skipped = reader.skippedRecords();
+                             }
+                             catch (const exception &e)
+                             {
+                                 error = e.what();
+                             }
+                             read.add(count, busy, 0, blocked);
+                             read_queue.close(); });
+    startPipelineStage(threads, normalize, read_queue, normalized_queue, [](PipelineItem &item)
+                       { item.doc.emplace(item.text); });
+    startPipelineStage(threads, segment, normalized_queue, segmented_queue, [&](PipelineItem &item)
+                       {
+                           item.analysis = analyzer.analyzeDocument(*item.doc, pmr::get_default_resource());
+                           item.doc.reset(); });
+    startPipelineStage(threads, score, segmented_queue, scored_queue, [&](PipelineItem &item)
+                       { item.result = analyzer.scoreDocument(move(item.analysis), item.text, profile, item.relevance); });
+    startPipelineStage(threads, serialize, scored_queue, serialized_queue, [&](PipelineItem &item)
+                       {
+                           if (binary)
+                               appendCompactEntry(item.record, item.id, item.result);
+                           else
+                               appendResultJson(item.record, item.id, item.result);
+                           item.result = ResumeAnalysisResult();
+                           string().swap(item.text); });
+
+    // Write in input order, holding back records that overtook an earlier one
+    map<size_t, unique_ptr<PipelineItem>> early;
+    size_t next = 0, documents = 0, bytes = 0;
+    uint64_t write_busy = 0, write_starved = 0;
+    unique_ptr<PipelineItem> item;
+    auto last = chrono::steady_clock::now();
+    while (serialized_queue.pop(item))
+    {
+        write_starved += since(last);
+        auto popped = chrono::steady_clock::now();
+        early.emplace(item->index, move(item));
+        while (!early.empty() && early.begin()->first == next)
+        {
+            const PipelineItem &ready = *early.begin()->second;
+            cout.write(ready.record.data(), ready.record.size());
+            if (write_delay_us > 0)
+                this_thread::sleep_for(chrono::microseconds(write_delay_us));
+            documents++;
+            bytes += ready.bytes;
+            early.erase(early.begin());
+            next++;
+            {
+                lock_guard<mutex> guard(flight_lock);
+                in_flight--;
+            }
+            flight_room.notify_one();
+        }
+        write_busy += since(popped);
+        last = chrono::steady_clock::now();
+    }
+    write.add(documents, write_busy, write_starved, 0);
+    for (auto &worker : threads)
+        worker.join();
+    cout.flush();
+    if (!error.empty())
+    {
+        cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    if (skipped > 0)
+        cerr << "Skipped " << skipped << " malformed record(s)\n";
+
+    double seconds = max(chrono::duration<double>(chrono::steady_clock::now() - start).count(), 1e-9);
+    cerr << "Scored " << documents << " resume(s), " << bytes / 1e6 << " MB in " << seconds << " s: "
+         << documents / seconds << " docs/s, " << bytes / 1e6 / seconds << " MB/s, peak memory "
+         << peakMemoryMegabytes() << " MB\n";
+    char line[160];
+    snprintf(line, sizeof(line), "%-10s %7s %8s %10s %14s %10s %10s\n", "stage", "workers", "items", "busy_s",
+             "docs/s/worker", "starved_s", "blocked_s");
+    cerr << line;
+    for (const PipelineStage *stage : stages)
+    {
+        double busy = stage->busy_ns / 1e9;
+        snprintf(line, sizeof(line), "%-10s %7zu %8llu %10.3f %14.0f %10.3f %10.3f\n", stage->name, stage->workers,
+                 static_cast<unsigned long long>(stage->items.load()), busy, busy > 0 ? stage->items / busy : 0.0,
+                 stage->starved_ns / 1e9, stage->blocked_ns / 1e9);
+        cerr << line;
+    }
+    snprintf(line, sizeof(line), "%-20s %8s %10s %9s %10s\n", "queue", "capacity", "mean_depth", "max_depth",
+             "full_waits");
+    cerr << line;
+    for (size_t q = 0; q < size(queues); q++)
+    {
+        string name = string(stages[q]->name) + ">" + stages[q + 1]->name;
+        BoundedQueue<unique_ptr<PipelineItem>>::Stats stats = queues[q]->stats();
+        snprintf(line, sizeof(line), "%-20s %8zu %10.1f %9zu %10llu\n", name.c_str(), queues[q]->capacity(),
+                 stats.mean_depth, stats.max_depth, static_cast<unsigned long long>(stats.full_pushes));
+        cerr << line;
+    }
+    return 0;
+}
+
+// Score a corpus against several jobs on the pool, batch by batch, and write the columnar export to out_path
+int runColumnExport(const string &corpus, const string &out_path, const vector<JobRequirements> &jobs, size_t threads)
+{
+    const size_t batch_size = 4096;
+    ResumeAnalyzer analyzer;
+    WorkStealingPool pool(threads);
+    BatchJobs batch(jobs);
+    ColumnWriter writer(jobs);
+    try
+    {
+        CorpusReader reader(corpus);
+        vector<string> ids, texts;
+        string id;
+        string_view text;
+        bool more = true;
+        while (more)
+        {
+            ids.clear();
+            texts.clear();
+            while (texts.size() < batch_size && (more = reader.next(id, text)))
+            {
+                ids.push_back(id);
+                texts.emplace_back(text);
+            }
+            vector<BatchRow> rows = analyzer.scoreBatch(texts, batch, pool);
+            for (size_t i = 0; i < texts.size(); i++)
+                writer.add(ids[i], rows[i], batch);
+        }
+        string bytes = writer.finish();
+        ofstream out(out_path, ios::binary | ios::trunc);
+        out.write(bytes.data(), bytes.size());
+        if (!out)
+            throw runtime_error("cannot write " + out_path);
+        cerr << "Exported " << writer.size() << " resume(s) x " << jobs.size() << " job(s), " << bytes.size()
+             << " bytes\n";
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Per-job statistics read straight from the columns of an export
+int runColumnSummary(const string &path)
+{
+    try
+    {
+        ColumnFile columns(path);
+        size_t n = columns.resumeCount();
+        cout << n << " resume(s), " << columns.jobCount() << " job(s)\n";
+        for (size_t j = 0; j < columns.jobCount(); j++)
+        {
+            const ColumnJob &job = columns.job(j);
+            const int16_t *ats = columns.atsScore(j);
+            double total = 0;
+            size_t best = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                total += ats[i];
+                if (ats[i] > ats[best])
+                    best = i;
+            }
+            cout << "Job " << j << ": " << job.skill_count << " skill(s), mean ATS " << (n ? total / n : 0.0);
+            if (n)
+                cout << ", best " << columns.id(best) << " (" << ats[best] << ")";
+            cout << "\n";
+            for (size_t k = 0; k < job.skill_count; k++)
+            {
+                size_t found = 0;
+                for (size_t i = 0; i < n; i++)
+                    found += columns.found(j, i, k);
+                cout << "  " << columns.skill(j, k) << ": found in " << found << "\n";
+            }
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Call visit(term) for every search term of text: lowercase runs of letters, digits, '+' and '#'
+// (so "C++" and "C#" survive), '.' and '-' between two such characters ("node.js", "b.tech"), and
+// non-ASCII characters except U+2000-U+2FFF punctuation and symbols such as bullets and arrows
+template <typename Visit>
+void forEachTerm(string_view text, string &scratch, Visit visit)
+{
+    auto isTermByte = [&](size_t i)
+    {
+        unsigned char b = static_cast<unsigned char>(text[i]);
+        if (b >= 0x80)
+            return b != 0xE2 && !(b < 0xC0 && i > 0 && (text[i - 1] == '\xE2' || (i > 1 && text[i - 2] == '\xE2')));
+        return isalnum(b) || b == '+' || b == '#';
+    };
+    size_t i = 0;
+    while (i < text.size())
+    {
+        if (!isTermByte(i))
+        {
+            i++;
+            continue;
+        }
+        scratch.clear();
+        while (i < text.size())
+        {
+            if (isTermByte(i))
+                scratch.push_back(static_cast<char>(tolower(static_cast<unsigned char>(text[i]))));
+            else if ((text[i] == '.' || text[i] == '-') && i + 1 < text.size() && isTermByte(i + 1))
+                scratch.push_back(text[i]);
+            else
+                break;
+            i++;
+        }
+        visit(string_view(scratch));
+    }
+}
+
+inline void appendVarint(vector<uint8_t> &out, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Read a varint that must end before end; false if it runs past end or does not fit in 32 bits
+inline bool readVarint(const uint8_t *&p, const uint8_t *end, uint32_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7)
+    {
+        uint8_t b = *p++;
+        value |= static_cast<uint32_t>(b & 0x7F) << shift;
+        if (b < 0x80)
+            return true;
+    }
+    return false;
+}
+
+// On-disk layout of a resume index (little-endian, every section 8-byte aligned):
+// header, document table, term table sorted by term, term strings, postings, document id strings.
+// Postings are delta-encoded varint document numbers, so the file can be mmapped and queried in place.
+struct IndexHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t document_count;
+    uint64_t term_count;
+    uint64_t documents_offset;
+    uint64_t terms_offset;
+    uint64_t term_strings_offset;
+    uint64_t postings_offset;
+    uint64_t document_strings_offset;
+    uint64_t file_size;
+};
+
+struct IndexDocument
+{
+    uint64_t id_offset;
+    uint32_t id_length;
+    int32_t ats_score;
+};
+
+struct IndexTerm
+{
+    uint64_t string_offset;
+    uint64_t postings_offset;
+    uint32_t string_length;
+    uint32_t document_frequency;
+    uint64_t postings_length;
+};
+
+static_assert(sizeof(IndexHeader) == 72 && sizeof(IndexDocument) == 16 && sizeof(IndexTerm) == 32,
+              "index structures are written to disk as-is");
+
+// Builds an inverted index over a corpus in memory and writes it in the IndexHeader format
+class ResumeIndexWriter
+{
+private:
+    struct Postings
+    {
+        vector<uint8_t> bytes;
+        uint32_t last_document = 0;
+        uint32_t document_frequency = 0;
+    };
+
+    unordered_map<string, Postings> postings;
+    vector<IndexDocument> documents;
+    string document_ids;
+    string scratch;
+
+    static void writeAligned(ofstream &out, const void *data, size_t size, uint64_t &offset)
+    {
+        out.write(static_cast<const char *>(data), size);
+        offset += size;
+        static const char padding[8] = {};
+        size_t pad = (8 - offset % 8) % 8;
+        out.write(padding, pad);
+        offset += pad;
+    }
+
+public:
+    // Add a resume with the ATS score used to order equally good matches
+    void add(string_view id, string_view text, int ats_score)
+    {
+        uint32_t document = static_cast<uint32_t>(documents.size());
+        documents.push_back(IndexDocument{document_ids.size(), static_cast<uint32_t>(id.size()), ats_score});
+        document_ids.append(id);
+        forEachTerm(text, scratch, [&](string_view term)
+                    {
+                        auto it = postings.find(string(term));
+                        if (it == postings.end())
+                            it = postings.emplace(string(term), Postings()).first;
+                        Postings &list = it->second;
+                        if (list.document_frequency > 0 && list.last_document == document)
+                            return;
+                        appendVarint(list.bytes, list.document_frequency == 0 ? document : document - list.last_document);
+                        list.last_document = document;
+                        list.document_frequency++; });
+    }
+
+    size_t documentCount() const { return documents.size(); }
+
+    // Write the index to path through a temporary file renamed into place
+    void write(const string &path) const
+    {
+        vector<const pair<const string, Postings> *> terms;
+        terms.reserve(postings.size());
+        for (const auto &entry : postings)
+            terms.push_back(&entry);
+        sort(terms.begin(), terms.end(), [](auto *a, auto *b)
+             { return a->first < b->first; });
+
+        vector<IndexTerm> term_table;
+        term_table.reserve(terms.size());
+        string term_strings;
+        uint64_t postings_size = 0;
+        for (auto *term : terms)
+        {
+            term_table.push_back(IndexTerm{term_strings.size(), postings_size, static_cast<uint32_t>(term->first.size()),
+                                           term->second.document_frequency, term->second.bytes.size()});
+            term_strings.append(term->first);
+            postings_size += term->second.bytes.size();
+        }
+
+        string temp_path = path + ".tmp";
+        ofstream out(temp_path, ios::binary | ios::trunc);
+        if (!out)
+            throw runtime_error(temp_path + ": " + strerror(errno));
+        IndexHeader header = {};
+        memcpy(header.magic, "ATSIDX1", 8);
+        header.version = 1;
+        header.document_count = static_cast<uint32_t>(documents.size());
+        header.term_count = term_table.size();
+        auto align = [](uint64_t offset)
+        { return (offset + 7) / 8 * 8; };
+        header.documents_offset = sizeof(IndexHeader);
+        header.terms_offset = align(header.documents_offset + documents.size() * sizeof(IndexDocument));
+        header.term_strings_offset = align(header.terms_offset + term_table.size() * sizeof(IndexTerm));
+        header.postings_offset = align(header.term_strings_offset + term_strings.size());
+        header.document_strings_offset = align(header.postings_offset + postings_size);
+        header.file_size = align(header.document_strings_offset + document_ids.size());
+
+        uint64_t offset = 0;
+        writeAligned(out, &header, sizeof(header), offset);
+        writeAligned(out, documents.data(), documents.size() * sizeof(IndexDocument), offset);
+        writeAligned(out, term_table.data(), term_table.size() * sizeof(IndexTerm), offset);
+        writeAligned(out, term_strings.data(), term_strings.size(), offset);
+        for (auto *term : terms)
+            out.write(reinterpret_cast<const char *>(term->second.bytes.data()), term->second.bytes.size());
+        offset += postings_size;
+        writeAligned(out, "", 0, offset);
+        writeAligned(out, document_ids.data(), document_ids.size(), offset);
+        out.close();
+        if (!out || offset != header.file_size)
+            throw runtime_error(temp_path + ": write failed");
+        filesystem::rename(temp_path, path);
+    }
+};
+
+// One resume returned by a search, with how many of the query skills it contains
+struct IndexHit
+{
+    uint32_t document;
+    string_view id;
+    int ats_score;
+    size_t matched_skills;
+};
+
+// A resume index mapped into memory and queried in place
+class ResumeIndex
+{
+private:
+    string path;
+    MappedFile file;
+    const IndexHeader *header;
+    const IndexDocument *documents;
+    const IndexTerm *terms;
+    const char *term_strings;
+    const uint8_t *postings;
+    const char *document_strings;
+
+    string_view termAt(size_t i) const
+    {
+        return string_view(term_strings + terms[i].string_offset, terms[i].string_length);
+    }
+
+    // Documents containing term, in increasing order
+    vector<uint32_t> lookup(string_view term) const
+    {
+        size_t low = 0, high = header->term_count;
+        while (low < high)
+        {
+            size_t mid = (low + high) / 2;
+            if (termAt(mid) < term)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        vector<uint32_t> result;
+        if (low == header->term_count || termAt(low) != term)
+            return result;
+        const IndexTerm &entry = terms[low];
+        result.reserve(entry.document_frequency);
+        const uint8_t *p = postings + entry.postings_offset, *end = p + entry.postings_length;
+        uint32_t document = 0, delta;
+        for (uint32_t i = 0; i < entry.document_frequency; i++)
+        {
+            // document is below document_count here, so the subtraction cannot wrap
+            if (!readVarint(p, end, delta) || delta >= header->document_count - document)
+                throw runtime_error(path + ": not a resume index");
+            document += delta;
+            result.push_back(document);
+        }
+        return result;
+    }
+
+    // Documents containing every term of a skill; multi-word skills match documents containing all the words
+    vector<uint32_t> lookupSkill(string_view skill) const
+    {
+        vector<vector<uint32_t>> lists;
+        string scratch;
+        forEachTerm(skill, scratch, [&](string_view term)
+                    { lists.push_back(lookup(term)); });
+        if (lists.empty())
+            return {};
+        sort(lists.begin(), lists.end(), [](const auto &a, const auto &b)
+             { return a.size() < b.size(); });
+        vector<uint32_t> result = lists[0];
+        for (size_t i = 1; i < lists.size() && !result.empty(); i++)
+        {
+            vector<uint32_t> both;
+            set_intersection(result.begin(), result.end(), lists[i].begin(), lists[i].end(), back_inserter(both));
+            result.swap(both);
+        }
+        return result;
+    }
+
+    // Whether the sections follow each other inside the file and every term and document id lies inside
+    // its section, so that queries never read outside the mapping
+    bool validLayout() const
+    {
+        const IndexHeader &h = *header;
+        auto fits = [](uint64_t offset, uint64_t count, uint64_t size, uint64_t end)
+        { return offset <= end && count <= (end - offset) / size; };
+        if (h.documents_offset < sizeof(IndexHeader) || h.documents_offset % 8 != 0 || h.terms_offset % 8 != 0 ||
+            !fits(h.documents_offset, h.document_count, sizeof(IndexDocument), h.terms_offset) ||
+            !fits(h.terms_offset, h.term_count, sizeof(IndexTerm), h.term_strings_offset) ||
+            h.term_strings_offset > h.postings_offset || h.postings_offset > h.document_strings_offset ||
+            h.document_strings_offset > h.file_size)
+            return false;
+        uint64_t term_strings_size = h.postings_offset - h.term_strings_offset;
+        uint64_t postings_size = h.document_strings_offset - h.postings_offset;
+        uint64_t document_strings_size = h.file_size - h.document_strings_offset;
+        for (uint64_t i = 0; i < h.term_count; i++)
+            if (!fits(terms[i].string_offset, terms[i].string_length, 1, term_strings_size) ||
+                !fits(terms[i].postings_offset, terms[i].postings_length, 1, postings_size) ||
+                terms[i].document_frequency > terms[i].postings_length)
+                return false;
+        for (uint32_t i = 0; i < h.document_count; i++)
+            if (!fits(documents[i].id_offset, documents[i].id_length, 1, document_strings_size))
+                return false;
+        return true;
+    }
+
+public:
+    explicit ResumeIndex(const string &index_path) : path(index_path), file(index_path)
+    {
+        string_view data = file.view();
+        header = reinterpret_cast<const IndexHeader *>(data.data());
+        if (data.size() < sizeof(IndexHeader) || memcmp(header->magic, "ATSIDX1", 8) != 0 || header->version != 1 ||
+            header->file_size != data.size())
+            throw runtime_error(path + ": not a resume index");
+        // Pointers are only formed once the offsets they come from are known to lie inside the file
+        auto at = [&](uint64_t offset)
+        { return data.data() + min<uint64_t>(offset, data.size()); };
+        documents = reinterpret_cast<const IndexDocument *>(at(header->documents_offset));
+        terms = reinterpret_cast<const IndexTerm *>(at(header->terms_offset));
+        term_strings = at(header->term_strings_offset);
+        postings = reinterpret_cast<const uint8_t *>(at(header->postings_offset));
+        document_strings = at(header->document_strings_offset);
+        if (!validLayout())
+            throw runtime_error(path + ": not a resume index");
+    }
+
+    size_t documentCount() const { return header->document_count; }
+    size_t termCount() const { return header->term_count; }
+
+    // Resumes containing all skills (match_all) or any of them, best first: more matched skills,
+    // then higher ATS score, then index order. total receives the number of matches before the limit.
+    vector<IndexHit> search(const vector<string> &skills, bool match_all, size_t limit, size_t *total = nullptr) const
+    {
+        vector<uint32_t> candidates;
+        vector<uint32_t> matched_count;
+        if (match_all)
+        {
+            vector<vector<uint32_t>> lists;
+            for (const auto &skill : skills)
+                lists.push_back(lookupSkill(skill));
+            sort(lists.begin(), lists.end(), [](const auto &a, const auto &b)
+                 { return a.size() < b.size(); });
+            if (!lists.empty())
+                candidates = lists[0];
+            for (size_t i = 1; i < lists.size() && !candidates.empty(); i++)
+            {
+                vector<uint32_t> both;
+                set_intersection(candidates.begin(), candidates.end(), lists[i].begin(), lists[i].end(),
+                                 back_inserter(both));
+                candidates.swap(both);
+            }
+            matched_count.assign(candidates.size(), static_cast<uint32_t>(skills.size()));
+        }
+        else
+        {
+            // Merge the lists, counting how many skills each document matched
+            vector<uint32_t> all;
+            for (const auto &skill : skills)
+            {
+                vector<uint32_t> list = lookupSkill(skill);
+                all.insert(all.end(), list.begin(), list.end());
+            }
+            sort(all.begin(), all.end());
+            for (size_t i = 0; i < all.size();)
+            {
+                size_t j = i;
+                while (j < all.size() && all[j] == all[i])
+                    j++;
+                candidates.push_back(all[i]);
+                matched_count.push_back(static_cast<uint32_t>(j - i));
+                i = j;
+            }
+        }
+
+        if (total)
+            *total = candidates.size();
+        vector<IndexHit> hits;
+        hits.reserve(candidates.size());
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            const IndexDocument &document = documents[candidates[i]];
+            hits.push_back(IndexHit{candidates[i], string_view(document_strings + document.id_offset, document.id_length),
+                                    document.ats_score, matched_count[i]});
+        }
+        auto better = [](const IndexHit &a, const IndexHit &b)
+        {
+            if (a.matched_skills != b.matched_skills)
+                return a.matched_skills > b.matched_skills;
+            if (a.ats_score != b.ats_score)
+                return a.ats_score > b.ats_score;
+            return a.document < b.document;
+        };
+        if (hits.size() > limit)
+        {
+            partial_sort(hits.begin(), hits.begin() + limit, hits.end(), better);
+            hits.resize(limit);
+        }
+        else
+            sort(hits.begin(), hits.end(), better);
+        return hits;
+    }
+};
+
+// Index every resume of a corpus, storing the ATS score each one gets against job
+int runIndexBuild(const string &corpus, const string &index_path, const JobRequirements &job)
+{
+    ResumeAnalyzer analyzer;
+    JobProfile profile(job);
+    ResumeIndexWriter writer;
+    auto start = chrono::steady_clock::now();
+    try
+    {
+        CorpusReader reader(corpus);
+        string id;
+        string_view text;
+        while (reader.next(id, text))
+            writer.add(id, text, analyzer.atsScoreOnly(text, profile));
+        writer.write(index_path);
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    ResumeIndex index(index_path);
+    cout << "Indexed " << index.documentCount() << " resume(s), " << index.termCount() << " terms in "
+         << elapsed.count() << " s\n";
+    return 0;
+}
+
+// Search an index for resumes with the given skills and print the best matches
+int runIndexQuery(const string &index_path, const vector<string> &skills, bool match_all, size_t limit)
+{
+    try
+    {
+        ResumeIndex index(index_path);
+        auto start = chrono::steady_clock::now();
+        size_t total = 0;
+        vector<IndexHit> hits = index.search(skills, match_all, limit, &total);
+        chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+        cout << total << " of " << index.documentCount() << " resume(s) matched in " << elapsed.count() << " ms\n";
+        for (size_t i = 0; i < hits.size(); i++)
+            cout << i + 1 << ". " << hits[i].id << " (skills " << hits[i].matched_skills << "/" << skills.size()
+                 << ", ATS " << hits[i].ats_score << ")\n";
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+// Read every record of a corpus into memory, reporting errors on stderr
+bool loadCorpus(const string &corpus, vector<string> &ids, vector<string> &resumes)
+{
+    try
+    {
+        CorpusReader reader(corpus);
+        string id;
+        string_view text;
+        while (reader.next(id, text))
+        {
+            ids.push_back(id);
+            resumes.emplace_back(text);
+        }
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return false;
+    }
+    return true;
+}
+
+// Rank a corpus for a job and print the best k resumes; with verify, compare against scoring every resume
+int runRanking(const string &corpus, const JobRequirements &job, size_t k, bool verify)
+{
+    ResumeAnalyzer analyzer;
+    auto relevance_corpus = make_shared<RelevanceCorpus>();
+    JobProfile profile(job, relevance_corpus);
+    vector<string> ids, resumes;
+    if (!loadCorpus(corpus, ids, resumes))
+        return 1;
+    // Relevance is ranked against idf statistics of the whole corpus
+    if (profile.relevance())
+        for (const auto &resume : resumes)
+            relevance_corpus->addDocument(resume);
+
+    RankingStats stats;
+    auto start = chrono::steady_clock::now();
+    vector<RankedResume> top = analyzer.rankTopK(resumes, profile, k, &stats);
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    for (size_t i = 0; i < top.size(); i++)
+        cout << i + 1 << ". " << ids[top[i].index] << " (ATS " << top[i].result.ats_score << ")\n";
+    cout << "Ranked " << stats.candidates << " resume(s) in " << elapsed.count() << " s: " << stats.fully_analyzed
+         << " fully analyzed, " << stats.skipped << " skipped\n";
+    if (!verify)
+        return 0;
+
+    start = chrono::steady_clock::now();
+    vector<pair<int, size_t>> all;
+    for (size_t i = 0; i < resumes.size(); i++)
+        all.emplace_back(-analyzer.analyzeResume(resumes[i], profile).ats_score, i);
+    sort(all.begin(), all.end());
+    elapsed = chrono::steady_clock::now() - start;
+    cout << "Exhaustive scoring took " << elapsed.count() << " s\n";
+    for (size_t i = 0; i < top.size(); i++)
+        if (all[i].second != top[i].index || -all[i].first != top[i].result.ats_score)
+        {
+            cout << "Mismatch at rank " << i + 1 << "\n";
+            return 1;
+        }
+    cout << "Top " << top.size() << " identical to exhaustive scoring\n";
+    return 0;
+}
+
+// Score a corpus repeat times on a pool with the stage timers on, then print per-stage latency quantiles
+int runStageProfile(const string &corpus, const JobRequirements &job, size_t repeat, size_t threads, bool json)
+{
+#ifdef ATS_NO_STAGE_TIMERS
+    cerr << "Stage timers were compiled out (ATS_NO_STAGE_TIMERS)\n";
+    return 1;
+#endif
+    ResumeAnalyzer analyzer;
+    JobProfile profile(job);
+    vector<string> ids, resumes;
+    if (!loadCorpus(corpus, ids, resumes))
+        return 1;
+    WorkStealingPool pool(threads);
+    StageProfiler::enabled() = true;
+    auto start = chrono::steady_clock::now();
+    for (size_t round = 0; round < repeat; round++)
+        pool.parallelFor(resumes.size(), [&](size_t begin, size_t end)
+                         {
+                             for (size_t i = begin; i < end; i++)
+                                 analyzer.analyzeResume(resumes[i], profile); });
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    StageProfiler::enabled() = false;
+    cerr << "Profiled " << resumes.size() * repeat << " analyses on " << pool.size() << " thread(s) in "
+         << elapsed.count() << " s\n";
+    cout << StageProfiler::report(json);
+    return 0;
+}
+
+// Scoring server protocol. Every message is a frame: a little-endian u32 payload length, then the payload.
+// Requests start with a u8 type and a u32 request id picked by the client; responses echo the id, then a
+// u8 status and a body. Responses may come back in any order, so a client can pipeline many requests.
+//   REQUEST_SCORE    u32 job id, resume text       -> the JSON record --stream prints, with the request id as "id"
+//   REQUEST_ADD_JOB  u8 require GPA, "skill,skill" -> u32 id of the new job
+// Job 0 is the job given on the server's command line.
+enum RequestType : uint8_t
+{
+    REQUEST_SCORE = 1,
+    REQUEST_ADD_JOB = 2
+};
+
+enum ResponseStatus : uint8_t
+{
+    STATUS_OK = 0,
+    STATUS_BAD_REQUEST = 1,
+    STATUS_UNKNOWN_JOB = 2
+};
+
+const uint32_t max_frame_size = 64u << 20;
+
+// Reserve a frame header in out; finishFrame fills in the length once the payload has been appended
+size_t beginFrame(string &out)
+{
+    size_t start = out.size();
+    appendRaw(out, uint32_t(0));
+    return start;
+}
+
+void finishFrame(string &out, size_t start)
+{
+    uint32_t length = static_cast<uint32_t>(out.size() - start - sizeof(uint32_t));
+    memcpy(&out[start], &length, sizeof(length));
+}
+
+// The next complete frame in buffer at offset, advancing offset past it; false if the frame is still incomplete
+bool nextFrame(string_view buffer, size_t &offset, string_view &payload)
+{
+    string_view rest = buffer.substr(offset);
+    uint32_t length;
+    if (!readRaw(rest, length))
+        return false;
+    if (length > max_frame_size)
+        throw runtime_error("frame of " + to_string(length) + " bytes exceeds the limit");
+    if (rest.size() < length)
+        return false;
+    payload = rest.substr(0, length);
+    offset += sizeof(uint32_t) + length;
+    return true;
+}
+
+// Address of a Unix domain socket at path
+sockaddr_un socketAddress(const string &path)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+        throw runtime_error("socket path too long: " + path);
+    memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+void setNonBlocking(int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+// Set by SIGINT/SIGTERM; the handler also writes to the server's wake pipe so poll returns
+volatile sig_atomic_t server_stop_requested = 0;
+int server_wake_fd = -1;
+
+void requestServerStop(int)
+{
+    server_stop_requested = 1;
+    char byte = 's';
+    if (write(server_wake_fd, &byte, 1) < 0)
+    {
+        // The pipe is full, so the loop is about to wake anyway
+    }
+}
+
+// Non-blocking pipe a thread writes a byte to so that a poll() loop wakes up
+class WakePipe
+{
+private:
+    int fds[2] = {-1, -1};
+
+public:
+    WakePipe()
+    {
+        if (pipe(fds) != 0)
+            throw runtime_error("cannot create wake pipe");
+        setNonBlocking(fds[0]);
+        setNonBlocking(fds[1]);
+    }
+
+    ~WakePipe()
+    {
+        if (server_wake_fd == fds[1])
+            server_wake_fd = -1;
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    WakePipe(const WakePipe &) = delete;
+    WakePipe &operator=(const WakePipe &) = delete;
+
+    int readEnd() const { return fds[0]; }
+    int writeEnd() const { return fds[1]; }
+};
+
+// A warm analyzer and compiled jobs behind a Unix domain socket. One thread runs a poll() loop that
+// accepts connections, splits input into frames and writes responses; scoring requests run on the
+// worker pool, which hands finished responses back through a wake pipe.
+class ScoringServer
+{
+private:
+    struct Connection
+    {
+        int fd;
+        string in;
+        string out;
+        size_t out_start = 0;
+        size_t pending = 0; // requests handed to workers and not yet answered
+        bool open = true;
+    };
+
+    // Stop reading from a connection with this much queued, until the client catches up
+    static const size_t max_pending = 4096;
+    static const size_t max_buffered_output = 16u << 20;
+
+    ResumeAnalyzer analyzer;
+    vector<shared_ptr<const JobProfile>> jobs; // only touched by the loop thread
+    unordered_map<uint64_t, Connection> connections;
+    uint64_t next_connection = 0;
+    int listen_fd = -1;
+    WakePipe wake_pipe;
+    string socket_path;
+    mutex done_lock;
+    vector<pair<uint64_t, string>> done; // (connection, response frame) from the workers
+    // Declared last, so it is destroyed first: its destructor runs the queued tasks and joins the workers
+    // while the wake pipe and the rest of the state they use are still there
+    WorkStealingPool pool;
+
+    static void appendResponseHeader(string &out, uint32_t request_id, ResponseStatus status)
+    {
+        appendRaw(out, request_id);
+        appendRaw(out, static_cast<uint8_t>(status));
+    }
+
+    void respond(Connection &connection, uint32_t request_id, ResponseStatus status, string_view body = {})
+    {
+        size_t start = beginFrame(connection.out);
+        appendResponseHeader(connection.out, request_id, status);
+        connection.out.append(body);
+        finishFrame(connection.out, start);
+    }
+
+    void handleRequest(uint64_t id, Connection &connection, string_view payload)
+    {
+        uint8_t type;
+        uint32_t request_id;
+        if (!readRaw(payload, type) || !readRaw(payload, request_id))
+            throw runtime_error("truncated request header");
+        if (type == REQUEST_ADD_JOB)
+        {
+            uint8_t require_gpa;
+            if (!readRaw(payload, require_gpa))
+                return respond(connection, request_id, STATUS_BAD_REQUEST);
+            jobs.push_back(make_shared<const JobProfile>(splitList(payload), require_gpa != 0));
+            string body;
+            appendRaw(body, static_cast<uint32_t>(jobs.size() - 1));
+            return respond(connection, request_id, STATUS_OK, body);
+        }
+        uint32_t job_id;
+        if (type != REQUEST_SCORE || !readRaw(payload, job_id))
+            return respond(connection, request_id, STATUS_BAD_REQUEST);
+        if (job_id >= jobs.size())
+            return respond(connection, request_id, STATUS_UNKNOWN_JOB);
+        connection.pending++;
+        pool.submit([this, id, request_id, job = jobs[job_id], text = string(payload)]
+                    {
+                        string frame;
+                        size_t start = beginFrame(frame);
+                        appendResponseHeader(frame, request_id, STATUS_OK);
+                        appendResultJson(frame, to_string(request_id), analyzer.analyzeResume(text, *job));
+                        finishFrame(frame, start);
+                        {
+                            lock_guard<mutex> guard(done_lock);
+                            done.emplace_back(id, move(frame));
+                        }
+                        char byte = 'd';
+                        if (write(wake_pipe.writeEnd(), &byte, 1) < 0)
+                        {
+                            // A full pipe already guarantees a wake-up
+                        } });
+    }
+
+    void readFrom(uint64_t id, Connection &connection)
+    {
+        char buffer[64 << 10];
+        while (true)
+        {
+            ssize_t n = read(connection.fd, buffer, sizeof(buffer));
+            if (n > 0)
+            {
+                connection.in.append(buffer, n);
+                continue;
+            }
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+                connection.open = false;
+            if (n == 0 || errno != EINTR)
+                break;
+        }
+        size_t offset = 0;
+        string_view payload;
+        try
+        {
+            while (nextFrame(connection.in, offset, payload))
+                handleRequest(id, connection, payload);
+        }
+        catch (const exception &e)
+        {
+            cerr << "Closing connection " << id << ": " << e.what() << "\n";
+            connection.open = false;
+        }
+        connection.in.erase(0, offset);
+    }
+
+    void writeTo(Connection &connection)
+    {
+        while (connection.out_start < connection.out.size())
+        {
+            ssize_t n = send(connection.fd, connection.out.data() + connection.out_start,
+                             connection.out.size() - connection.out_start, MSG_NOSIGNAL);
+            if (n > 0)
+            {
+                connection.out_start += n;
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                connection.open = false;
+            if (errno != EINTR)
+                break;
+        }
+        if (connection.out_start == connection.out.size())
+        {
+            connection.out.clear();
+            connection.out_start = 0;
+        }
+    }
+
+    // Move finished responses to their connections; answers for connections that closed are dropped
+    void collectResponses()
+    {
+        char drain[256];
+        while (read(wake_pipe.readEnd(), drain, sizeof(drain)) > 0)
+        {
+        }
+        vector<pair<uint64_t, string>> finished;
+        {
+            lock_guard<mutex> guard(done_lock);
+            finished.swap(done);
+        }
+        for (auto &response : finished)
+        {
+            auto it = connections.find(response.first);
+            if (it == connections.end())
+                continue;
+            it->second.out += response.second;
+            it->second.pending--;
+        }
+    }
+
+    void acceptConnections()
+    {
+        while (true)
+        {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0)
+                return;
+            setNonBlocking(fd);
+            connections[next_connection++].fd = fd;
+        }
+    }
+
+public:
+    ScoringServer(const string &path, const JobRequirements &default_job, size_t workers)
+        : socket_path(path), pool(workers)
+    {
+        jobs.push_back(make_shared<const JobProfile>(default_job));
+        sockaddr_un address = socketAddress(path);
+        listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        unlink(path.c_str());
+        if (listen_fd < 0 || ::bind(listen_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+            listen(listen_fd, 128) != 0)
+            throw runtime_error("cannot listen on " + path + ": " + strerror(errno));
+        setNonBlocking(listen_fd);
+    }
+
+    ~ScoringServer()
+    {
+        for (auto &entry : connections)
+            close(entry.second.fd);
+        if (listen_fd >= 0)
+        {
+            close(listen_fd);
+            unlink(socket_path.c_str());
+        }
+    }
+
+    size_t workerCount() const { return pool.size(); }
+
+    // Serve until SIGINT or SIGTERM
+    void run()
+    {
+        server_wake_fd = wake_pipe.writeEnd();
+        signal(SIGINT, requestServerStop);
+        signal(SIGTERM, requestServerStop);
+        vector<pollfd> fds;
+        vector<uint64_t> ids;
+        while (!server_stop_requested)
+        {
+            fds.assign({{listen_fd, POLLIN, 0}, {wake_pipe.readEnd(), POLLIN, 0}});
+            ids.clear();
+            for (auto &entry : connections)
+            {
+                Connection &connection = entry.second;
+                short events = 0;
+                if (connection.pending < max_pending && connection.out.size() < max_buffered_output)
+                    events |= POLLIN;
+                if (connection.out_start < connection.out.size())
+                    events |= POLLOUT;
+                fds.push_back({connection.fd, events, 0});
+                ids.push_back(entry.first);
+            }
+            if (poll(fds.data(), fds.size(), -1) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                throw runtime_error(string("poll failed: ") + strerror(errno));
+            }
+            if (fds[1].revents)
+                collectResponses();
+            if (fds[0].revents & POLLIN)
+                acceptConnections();
+            for (size_t i = 0; i < ids.size(); i++)
+            {
+                Connection &connection = connections[ids[i]];
+                if (fds[i + 2].revents & (POLLIN | POLLHUP | POLLERR))
+                    readFrom(ids[i], connection);
+            }
+            for (auto it = connections.begin(); it != connections.end();)
+            {
+                Connection &connection = it->second;
+                if (connection.open && connection.out_start < connection.out.size())
+                    writeTo(connection);
+                if (!connection.open)
+                {
+                    close(connection.fd);
+                    it = connections.erase(it);
+                }
+                else
+                    ++it;
+            }
+        }
+    }
+};
+
+int runServer(const string &path, const JobRequirements &job, size_t workers)
+{
+    try
+    {
+        ScoringServer server(path, job, workers);
+        cerr << "Serving on " << path << " with " << server.workerCount() << " worker(s)\n";
+        server.run();
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    cerr << "Server stopped\n";
+    return 0;
+}
+
+// Connect to a scoring server at path
+int connectToServer(const string &path)
+{
+    sockaddr_un address = socketAddress(path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        if (fd >= 0)
+            close(fd);
+        throw runtime_error("cannot connect to " + path + ": " + strerror(errno));
+    }
+    return fd;
+}
+
+// Register a job on a fresh connection and wait for its id
+uint32_t registerJob(const string &path, const JobRequirements &job)
+{
+    int fd = connectToServer(path);
+    string request, skills;
+    for (const auto &skill : job.required_skills)
+        skills += (skills.empty() ? "" : ",") + skill;
+    size_t start = beginFrame(request);
+    appendRaw(request, static_cast<uint8_t>(REQUEST_ADD_JOB));
+    appendRaw(request, uint32_t(0));
+    appendRaw(request, static_cast<uint8_t>(job.require_gpa));
+    request += skills;
+    finishFrame(request, start);
+    string response;
+    bool sent = send(fd, request.data(), request.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(request.size());
+    size_t offset = 0;
+    string_view payload;
+    char buffer[256];
+    ssize_t n;
+    while (sent && !nextFrame(response, offset, payload) && (n = read(fd, buffer, sizeof(buffer))) > 0)
+        response.append(buffer, n);
+    close(fd);
+    uint32_t request_id, job_id;
+    uint8_t status;
+    if (!sent || offset == 0 || !readRaw(payload, request_id) || !readRaw(payload, status) || status != STATUS_OK ||
+        !readRaw(payload, job_id))
+        throw runtime_error("job registration failed");
+    return job_id;
+}
+
+// Drive a server with requests resumes from a corpus over several connections, keeping up to
+// pipeline requests in flight on each, and report the sustained rate and latency quantiles
+int runLoadGenerator(const string &path, const string &corpus, const JobRequirements *job, size_t connection_count,
+                     size_t pipeline, size_t requests)
+{
+    vector<string> ids, resumes;
+    if (!loadCorpus(corpus, ids, resumes))
+        return 1;
+    if (resumes.empty())
+    {
+        cerr << "Error: empty corpus\n";
+        return 1;
+    }
+    struct Client
+    {
+        int fd;
+        string in, out;
+        size_t out_start = 0;
+        unordered_map<uint32_t, chrono::steady_clock::time_point> in_flight;
+    };
+    vector<Client> clients;
+    auto histogram = make_unique<LatencyHistogram>();
+    size_t sent = 0, completed = 0, failed = 0;
+    chrono::duration<double> elapsed{};
+    try
+    {
+        uint32_t job_id = job ? registerJob(path, *job) : 0;
+        for (size_t i = 0; i < max<size_t>(1, connection_count); i++)
+        {
+            Client client;
+            client.fd = connectToServer(path);
+            setNonBlocking(client.fd);
+            clients.push_back(move(client));
+        }
+        vector<pollfd> fds(clients.size());
+        auto start = chrono::steady_clock::now();
+        while (completed < requests)
+        {
+            for (size_t c = 0; c < clients.size(); c++)
+            {
+                Client &client = clients[c];
+                while (client.in_flight.size() < pipeline && sent < requests)
+                {
+                    const string &resume = resumes[sent % resumes.size()];
+                    uint32_t request_id = static_cast<uint32_t>(sent++);
+                    size_t frame = beginFrame(client.out);
+                    appendRaw(client.out, static_cast<uint8_t>(REQUEST_SCORE));
+                    appendRaw(client.out, request_id);
+                    appendRaw(client.out, job_id);
+                    client.out += resume;
+                    finishFrame(client.out, frame);
+                    client.in_flight[request_id] = chrono::steady_clock::now();
+                }
+                fds[c] = {client.fd, static_cast<short>(POLLIN | (client.out_start < client.out.size() ? POLLOUT : 0)), 0};
+            }
+            if (poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR)
+                throw runtime_error(string("poll failed: ") + strerror(errno));
+            for (size_t c = 0; c < clients.size(); c++)
+            {
+                Client &client = clients[c];
+                if (fds[c].revents & POLLOUT)
+                {
+                    ssize_t n = send(client.fd, client.out.data() + client.out_start, client.out.size() - client.out_start,
+                                     MSG_NOSIGNAL);
+                    if (n < 0 && errno != EAGAIN && errno != EINTR)
+                        throw runtime_error("connection lost");
+                    client.out_start += max<ssize_t>(n, 0);
+                    if (client.out_start == client.out.size())
+                    {
+                        client.out.clear();
+                        client.out_start = 0;
+                    }
+                }
+                if (!(fds[c].revents & (POLLIN | POLLHUP | POLLERR)))
+                    continue;
+                char buffer[64 << 10];
+                ssize_t n = read(client.fd, buffer, sizeof(buffer));
+                if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR))
+                    throw runtime_error("server closed the connection");
+                if (n > 0)
+                    client.in.append(buffer, n);
+                size_t offset = 0;
+                string_view payload;
+                while (nextFrame(client.in, offset, payload))
+                {
+                    uint32_t request_id;
+                    uint8_t status;
+                    if (!readRaw(payload, request_id) || !readRaw(payload, status))
+                        throw runtime_error("malformed response");
+                    auto it = client.in_flight.find(request_id);
+                    if (it == client.in_flight.end())
+                        throw runtime_error("response to unknown request " + to_string(request_id));
+                    histogram->record(
+                        chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - it->second).count());
+                    client.in_flight.erase(it);
+                    completed++;
+                    failed += status != STATUS_OK;
+                }
+                client.in.erase(0, offset);
+            }
+        }
+        elapsed = chrono::steady_clock::now() - start;
+    }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        for (auto &client : clients)
+            close(client.fd);
+        return 1;
+    }
+    for (auto &client : clients)
+        close(client.fd);
+    vector<uint64_t> counts(LatencyHistogram::bucket_count);
+    histogram->addTo(counts);
+    cout << completed << " requests (" << failed << " failed) over " << clients.size() << " connection(s), pipeline "
+         << pipeline << ": " << completed / max(elapsed.count(), 1e-9) << " requests/s\n";
+    cout << "Latency us: p50 " << histogramQuantile(counts, completed, 0.5) / 1e3 << ", p99 "
+         << histogramQuantile(counts, completed, 0.99) / 1e3 << ", p999 "
+         << histogramQuantile(counts, completed, 0.999) / 1e3 << "\n";
+    return failed == 0 ? 0 : 1;
+}
+
+// splitmix64: tiny and fully specified, so a seed produces the same corpus on every platform and commit
+class SplitMix64
+{
+private:
+    uint64_t state;
+
+public:
+    explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+    uint64_t next()
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    size_t below(size_t n) { return next() % n; }
+    size_t between(size_t low, size_t high) { return low + below(high - low + 1); }
+    bool chance(double p) { return (next() >> 11) * 0x1.0p-53 < p; }
+
+    template <typename T>
+    const T &pick(const vector<T> &items) { return items[below(items.size())]; }
+};
+
+// Deterministic synthetic resumes and jobs for benchmarks: varying section mixes and header styles,
+// ASCII and Unicode bullets, several contact formats, and sizes measured in pages of about 3 KB
+class ResumeGenerator
+{
+private:
+    SplitMix64 rng;
+
+    static const vector<string> &words(int list)
+    {
+        static const vector<vector<string>> lists = {
+            {"Aarav", "Priya", "John", "Mei", "Carlos", "Fatima", "Olga", "Kwame", "Sofia", "Hiro", "Tanmya", "Lena"},
+            {"Sharma", "Potdar", "Smith", "Chen", "Garcia", "Khan", "Ivanova", "Mensah", "Rossi", "Tanaka", "Okafor"},
+            {"Acme Corp", "Globex", "Initech", "Umbrella Labs", "Stark Industries", "Hooli", "Wayne Systems",
+             "Tyrell Analytics", "Cyberdyne", "Soylent Data"},
+            {"Software Engineer", "Backend Developer", "Data Engineer", "SDE Intern", "Research Assistant",
+             "Site Reliability Engineer", "Full Stack Developer", "ML Engineer"},
+            {"IIT Ropar", "State University", "Institute of Technology", "City College", "National University"},
+            {"Bachelor of Technology in Computer Science", "Master of Science in Data Science",
+             "B.Tech in Electrical Engineering", "Diploma in Software Engineering", "PhD in Machine Learning",
+             "Bachelor of Science in Mathematics"},
+            {"Developed", "Implemented", "Designed", "Led", "Improved", "Created", "Managed", "Built", "Optimized",
+             "Migrated", "Automated", "Refactored"},
+            {"a distributed cache", "the billing pipeline", "an internal search service", "CI workflows",
+             "a recommendation model", "the mobile onboarding flow", "real-time dashboards", "the payments API",
+             "a log ingestion system", "data validation jobs"},
+            {"reducing p99 latency by 40%", "serving 2M requests per day", "cutting cloud costs by 25%",
+             "with 99.95% availability", "across 12 teams", "improving conversion by 8%", "in under three months"},
+            {"Weather Application", "Chess Engine", "Expense Tracker", "Compiler for a Toy Language", "Chat Server",
+             "Image Classifier", "Portfolio Website", "Ride Sharing Simulator"}};
+        return lists[list];
+    }
+    enum WordList
+    {
+        FIRST_NAMES,
+        LAST_NAMES,
+        COMPANIES,
+        TITLES,
+        SCHOOLS,
+        DEGREES,
+        VERBS,
+        OBJECTS,
+        OUTCOMES,
+        PROJECT_NAMES
+    };
+
+    string header(const char *upper, const char *title)
+    {
+        return rng.chance(0.7) ? upper : title;
+    }
+
+    string bullet()
+    {
+        static const vector<string> bullets = {"• ", "- ", "* ", "→ ", "– ", "•"};
+        return rng.pick(bullets);
+    }
+
+    string year(size_t low, size_t high) { return to_string(rng.between(low, high)); }
+
+    string achievement()
+    {
+        return bullet() + rng.pick(words(VERBS)) + " " + rng.pick(words(OBJECTS)) + " using " +
+               rng.pick(skillPool()) + " and " + rng.pick(skillPool()) + ", " + rng.pick(words(OUTCOMES)) + ".\n";
+    }
+
+public:
+    static const size_t bytes_per_page = 3000;
+
+    explicit ResumeGenerator(uint64_t seed) : rng(seed) {}
+
+    // Real skill names followed by invented framework names, 600 in all, so jobs of up to 500 skills exist
+    static const vector<string> &skillPool()
+    {
+        static const vector<string> pool = []
         {
-            if (trim(lines[i]).empty() && trim(lines[i + 1]).empty())
+            vector<string> skills = {
+                "C++", "Python", "SQL", "Java", "JavaScript", "TypeScript", "Go", "Rust", "Kotlin", "Swift",
+                "C#", "Ruby", "PHP", "Scala", "Haskell", "R", "MATLAB", "Bash", "Perl", "Lua",
+                "React", "Vue", "Angular", "Svelte", "Node.js", "Django", "Flask", "Spring", "Rails", "Express",
+                "Docker", "Kubernetes", "Terraform", "Ansible", "AWS", "GCP", "Azure", "Linux", "Git", "Jenkins",
+                "PostgreSQL", "MySQL", "MongoDB", "Redis", "Cassandra", "Elasticsearch", "Kafka", "RabbitMQ",
+                "Spark", "Hadoop", "Airflow", "Snowflake", "TensorFlow", "PyTorch", "Pandas", "NumPy",
+                "scikit-learn", "OpenCV", "CUDA", "LLVM", "GraphQL", "gRPC", "REST", "Tailwind CSS", "HTML",
+                "CSS", "Figma", "Jira", "Prometheus", "Grafana", "Nginx", "Unity", "Unreal", "Qt", "Boost",
+                "CMake", "Bazel", "Selenium", "Cypress", "Jest"};
+            SplitMix64 names(0x5EED);
+            const vector<string> syllables = {"zor", "lex", "qua", "vin", "tra", "mol", "dex", "ryn", "kas",
+                                              "pho", "ul", "nex", "bri", "sto", "gal", "wex"};
+            set<string> taken;
+            for (const auto &skill : skills)
+                taken.insert(toLower(skill));
+            while (skills.size() < 600)
             {
-                score -= 15;
-                deductions.push_back("Inconsistent spacing between sections");
-                break;
+                string name = names.pick(syllables) + names.pick(syllables) + names.pick(syllables);
+                name[0] = static_cast<char>(name[0] - 32);
+                if (taken.insert(toLower(name)).second)
+                    skills.push_back(name);
             }
-        }
-        // Check for proper contact information formatting using regex
-        regex email_pattern(R"(\b[\w\.-]+@[\w\.-]+\.\w+\b)");
-        regex phone_pattern(R"(\b\d{3}[-.]?\d{3}[-.]?\d{4}\b)");
-        regex linkedin_pattern(R"(linkedin\.com/\w+)");
-        if (!regex_search(text, email_pattern) &&
-            !regex_search(text, phone_pattern) &&
-            !regex_search(text, linkedin_pattern))
-        {
-            score -= 15;
-            deductions.push_back("Missing or improperly formatted contact information");
-        }
-        return make_pair(max(0, score), deductions);
+            return skills;
+        }();
+        return pool;
     }
 
-    PersonalInfo extractPersonalInfo(const string &text)
+    // count distinct skills, drawn mostly from the well-known names
+    vector<string> jobSkills(size_t count)
     {
-        PersonalInfo info;
-        regex email_pattern(R"([\w\.-]+@[\w\.-]+\.\w+)");
-        regex phone_pattern(R"((\+\d{1,3}[-.]?)?\s*\(?\d{3}\)?[-.]?\s*\d{3}[-.]?\s*\d{4})");
-        regex linkedin_pattern(R"(linkedin\.com/in/[\w-]+)");
-        regex github_pattern(R"(github\.com/[\w-]+)");
-        regex codeforces_pattern(R"(codeforces\.com/profile/[\w-]+)");
-        smatch match;
-        if (regex_search(text, match, email_pattern))
-            info.email = match.str(0);
-        if (regex_search(text, match, phone_pattern))
-            info.phone = match.str(0);
-        if (regex_search(text, match, linkedin_pattern))
-            info.linkedin = match.str(0);
-        if (regex_search(text, match, github_pattern))
-            info.github = match.str(0);
-        if (regex_search(text, match, codeforces_pattern))
-            info.codeforces = match.str(0);
-        // Assume the first non-empty line is the candidate's name.
-        istringstream iss(text);
-        getline(iss, info.name);
-        info.name = trim(info.name);
-        if (info.name.empty())
-            info.name = "Unknown";
-        // info.portfolio = "";
-        return info;
+        const vector<string> &pool = skillPool();
+        vector<size_t> order(pool.size());
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = i;
+        for (size_t i = order.size() - 1; i > 0; i--)
+            swap(order[i], order[rng.below(i + 1)]);
+        // Favour the real names so resumes and jobs overlap
+        vector<char> favoured(pool.size());
+        for (size_t i = 0; i < 80; i++)
+            favoured[i] = rng.chance(0.8);
+        stable_partition(order.begin(), order.end(), [&](size_t i)
+                         { return favoured[i] != 0; });
+        vector<string> skills;
+        for (size_t i = 0; i < count && i < order.size(); i++)
+            skills.push_back(pool[order[i]]);
+        return skills;
     }
 
-    // Extract education section(s) from the resume text
-    vector<string> extractEducation(const string &text)
-    {
-        vector<string> education;
-        vector<string> lines;
-        istringstream iss(text);
-        string line;
-        while (getline(iss, line))
-            lines.push_back(line);
-        vector<string> education_keywords = {"education", "academic", "qualification", "degree", "university", "college",
-                                             "school", "institute", "certification", "diploma", "bachelor", "master",
-                                             "phd", "b.tech", "m.tech", "b.e", "m.e", "b.sc", "m.sc", "bca", "mca",
-                                             "b.com", "m.com", "b.cs-it", "imca", "bba", "mba", "honors", "scholarship"};
-        bool inEducationSection = false;
-        vector<string> current_entry;
-        for (auto &ln : lines)
-        {
-            string trimmed = trim(ln);
-            string lower_ln = toLower(trimmed);
-            bool isHeader = false;
-            for (auto &keyword : education_keywords)
-            {
-                if (lower_ln.find(keyword) != string::npos)
-                {
-                    isHeader = true;
-                    break;
-                }
-            }
-            if (isHeader)
-            {
-                // If the line is not exactly just a header, record it
-                if (!trimmed.empty())
-                    current_entry.push_back(trimmed);
-                inEducationSection = true;
-                continue;
-            }
-            if (inEducationSection)
-            {
-                bool hitOtherSection = false;
-                // Check if line might belong to another section using resume keywords
-                for (auto &kw : file)
-                {
-                    if (lower_ln.find(kw) != string::npos)
-                    {
-                        hitOtherSection = true;
-                        break;
-                    }
-                }
-                if (hitOtherSection)
-                {
-                    inEducationSection = false;
-                    if (!current_entry.empty())
-                    {
-                        ostringstream oss;
-                        for (auto &part : current_entry)
-                            oss << part << " ";
-                        education.push_back(oss.str());
-                        current_entry.clear();
-                    }
-                    continue;
-                }
-                if (!trimmed.empty())
-                    current_entry.push_back(trimmed);
-                else if (!current_entry.empty())
-                {
-                    ostringstream oss;
-                    for (auto &part : current_entry)
-                        oss << part << " ";
-                    education.push_back(oss.str());
-                    current_entry.clear();
-                }
-            }
+    string resume(size_t pages)
+    {
+        string first = rng.pick(words(FIRST_NAMES)), last = rng.pick(words(LAST_NAMES));
+        string handle = toLower(first) + toLower(last) + to_string(rng.below(100));
+        string text = first + " " + last + "\n";
+        if (rng.chance(0.9))
+            text += "Email: " + handle + (rng.chance(0.5) ? "@gmail.com" : "@iitrpr.ac.in") + "\n";
+        if (rng.chance(0.85))
+        {
+            static const vector<string> formats = {"+91 98765 43210", "(555) 123-4567", "6362127519",
+                                                   "+1-202-555-0143", "98765-43210"};
+            text += "Phone: " + rng.pick(formats) + "\n";
         }
-        if (!current_entry.empty())
+        if (rng.chance(0.7))
+            text += "LinkedIn: linkedin.com/in/" + handle + "\n";
+        if (rng.chance(0.5))
+            text += "GitHub: github.com/" + handle + "\n";
+        if (rng.chance(0.2))
+            text += "Codeforces: codeforces.com/profile/" + handle + "\n";
+        text += "\n";
+
+        if (rng.chance(0.6))
+            text += header("PROFESSIONAL SUMMARY", "Summary") + "\nExperienced " + rng.pick(words(TITLES)) +
+                    " with expertise in " + rng.pick(skillPool()) + " and " + rng.pick(skillPool()) + ".\n\n";
+        if (rng.chance(0.9))
         {
-            ostringstream oss;
-            for (auto &part : current_entry)
-                oss << part << " ";
-            education.push_back(oss.str());
+            text += header("EDUCATION", "Education") + "\n";
+            size_t start = rng.between(2008, 2020);
+            text += bullet() + rng.pick(words(DEGREES)) + " from " + rng.pick(words(SCHOOLS)) + " (" +
+                    to_string(start) + " - " + to_string(start + 4) + ")\n";
+            if (rng.chance(0.6))
+                text += "CGPA: " + to_string(rng.between(60, 99) / 10.0).substr(0, 3) + "/10\n";
+            text += "\n";
         }
-        return education;
-    }
+        string skills_line;
+        for (size_t i = 0, n = rng.between(5, 40); i < n; i++)
+            skills_line += (i ? ", " : "") + (rng.chance(0.7) ? skillPool()[rng.below(80)] : rng.pick(skillPool()));
+        string skills_section = header("SKILLS", "Technical Skills") + "\n" + skills_line + "\n\n";
+        bool skills_first = rng.chance(0.3);
+        if (skills_first)
+            text += skills_section;
 
-    // Extract work experience section(s) from the resume text
-    vector<string> extractExperience(const string &text)
-    {
-        vector<string> experience;
-        vector<string> lines;
-        istringstream iss(text);
-        string line;
-        while (getline(iss, line))
-            lines.push_back(line);
-        vector<string> experience_keywords = {"experience", "employment", "work history", "professional experience",
-                                              "work experience", "career history", "professional background",
-                                              "employment history", "job history", "positions held", "job title",
-                                              "job responsibilities", "job description", "job summary"};
-        bool inExperienceSection = false;
-        vector<string> current_entry;
-        for (auto &ln : lines)
-        {
-            string trimmed = trim(ln);
-            string lower_ln = toLower(trimmed);
-            bool isHeader = false;
-            for (auto &keyword : experience_keywords)
-            {
-                if (lower_ln.find(keyword) != string::npos)
-                {
-                    isHeader = true;
-                    break;
-                }
+        // Experience and project entries until the target size is reached
+        size_t target = max<size_t>(1, pages) * bytes_per_page;
+        string experience = header(rng.chance(0.5) ? "EXPERIENCE" : "WORK EXPERIENCE", "Professional Experience") + "\n";
+        string projects = header("PROJECTS", "Academic Projects") + "\n";
+        bool has_experience = rng.chance(0.85), has_projects = rng.chance(0.8);
+        if (!has_experience && !has_projects)
+            has_projects = true;
+        while (text.size() + experience.size() + projects.size() + skills_section.size() < target)
+        {
+            if (has_experience && (!has_projects || rng.chance(0.6)))
+            {
+                size_t start = rng.between(2010, 2023);
+                experience += rng.pick(words(TITLES)) + " at " + rng.pick(words(COMPANIES)) + " (" + to_string(start) +
+                              " - " + (rng.chance(0.3) ? string("Present") : to_string(start + rng.between(1, 4))) + ")\n";
+                for (size_t i = 0, n = rng.between(2, 6); i < n; i++)
+                    experience += achievement();
+                experience += "\n";
             }
-            if (isHeader)
+            else
             {
-                if (!trimmed.empty())
-                    current_entry.push_back(trimmed);
-                inExperienceSection = true;
-                continue;
+                projects += bullet() + rng.pick(words(PROJECT_NAMES)) + " " + year(2015, 2024) + " | " +
+                            rng.pick(skillPool()) + ", " + rng.pick(skillPool()) + "\n";
+                for (size_t i = 0, n = rng.between(1, 4); i < n; i++)
+                    projects += achievement();
+                projects += "\n";
             }
-            if (inExperienceSection)
+        }
+        if (has_experience)
+            text += experience;
+        if (has_projects)
+            text += projects;
+        if (!skills_first)
+            text += skills_section;
+        if (rng.chance(0.3))
+            text += header("ACHIEVEMENTS", "Achievements") + "\n" + bullet() + "Ranked " + to_string(rng.between(1, 500)) +
+                    " in a national coding contest\n";
+        return text;
+    }
+};
+
+// A seeded corpus of count resumes of min_pages to max_pages pages each
+vector<string> generateCorpus(uint64_t seed, size_t count, size_t min_pages, size_t max_pages)
+{
+    ResumeGenerator generator(seed);
+    SplitMix64 sizes(seed ^ 0x512Eull);
+    vector<string> resumes;
+    for (size_t i = 0; i < count; i++)
+        resumes.push_back(generator.resume(sizes.between(min_pages, max_pages)));
+    return resumes;
+}
+
+// Write a generated corpus in any format CorpusReader accepts: a .jsonl/.ndjson or .lp file, or else a directory
+int runGenerate(const string &path, uint64_t seed, size_t count, size_t min_pages, size_t max_pages)
+{
+    vector<string> resumes = generateCorpus(seed, count, min_pages, max_pages);
+    string extension = filesystem::path(path).extension().string();
+    try
+    {
+        if (extension == ".jsonl" || extension == ".ndjson" || extension == ".lp")
+        {
+            ofstream out(path, ios::binary);
+            string record;
+            for (size_t i = 0; i < resumes.size(); i++)
             {
-                bool hitOtherSection = false;
-                for (auto &kw : file)
+                record.clear();
+                if (extension == ".lp")
                 {
-                    if (lower_ln.find(kw) != string::npos)
-                    {
-                        hitOtherSection = true;
-                        break;
-                    }
-                }
-                if (hitOtherSection)
-                {
-                    inExperienceSection = false;
-                    if (!current_entry.empty())
-                    {
-                        ostringstream oss;
-                        for (auto &part : current_entry)
-                            oss << part << " ";
-                        experience.push_back(oss.str());
-                        current_entry.clear();
-                    }
-                    continue;
+                    appendRaw(record, static_cast<uint32_t>(resumes[i].size()));
+                    record += resumes[i];
                 }
-                if (!trimmed.empty())
-                    current_entry.push_back(trimmed);
-                else if (!current_entry.empty())
+                else
                 {
-                    ostringstream oss;
-                    for (auto &part : current_entry)
-                        oss << part << " ";
-                    experience.push_back(oss.str());
-                    current_entry.clear();
+                    record += "{\"id\":";
+                    appendJsonString(record, "resume-" + to_string(i));
+                    record += ",\"text\":";
+                    appendJsonString(record, resumes[i]);
+                    record += "}\n";
                 }
+                out.write(record.data(), record.size());
             }
+            if (!out)
+                throw runtime_error("cannot write " + path);
         }
-        if (!current_entry.empty())
+        else
         {
-            ostringstream oss;
-            for (auto &part : current_entry)
-                oss << part << " ";
-            experience.push_back(oss.str());
+            filesystem::create_directories(path);
+            for (size_t i = 0; i < resumes.size(); i++)
+            {
+                char name[32];
+                snprintf(name, sizeof(name), "resume-%06zu.txt", i);
+                ofstream out(filesystem::path(path) / name, ios::binary);
+                out.write(resumes[i].data(), resumes[i].size());
+                if (!out)
+                    throw runtime_error("cannot write " + (filesystem::path(path) / name).string());
+            }
         }
-        return experience;
     }
+    catch (const exception &e)
+    {
+        cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    size_t bytes = 0;
+    for (const auto &resume : resumes)
+        bytes += resume.size();
+    cerr << "Wrote " << resumes.size() << " resume(s), " << bytes / 1e6 << " MB to " << path << "\n";
+    return 0;
+}
 
-    // Extract projects section(s) from the resume text
-    vector<string> extractProjects(const string &text)
-    {
-        vector<string> projects;
-        vector<string> lines;
-        istringstream iss(text);
-        string line;
-        while (getline(iss, line))
-            lines.push_back(line);
-        vector<string> project_keywords = {"projects", "personal projects", "academic projects", "key projects",
-                                           "major projects", "professional projects", "project experience",
-                                           "relevant projects", "featured projects", "latest projects", "top projects"};
-        bool inProjectSection = false;
-        vector<string> current_entry;
-        for (auto &ln : lines)
-        {
-            string trimmed = trim(ln);
-            string lower_ln = toLower(trimmed);
-            bool isHeader = false;
-            for (auto &keyword : project_keywords)
-            {
-                if (lower_ln.find(keyword) != string::npos)
-                {
-                    isHeader = true;
-                    break;
-                }
-            }
-            if (isHeader)
+// Resident set size of the process and its peak since it started or since resetPeakResident(), in
+// megabytes (VmRSS and VmHWM of /proc/self/status), or nullopt where that is not available
+optional<pair<double, double>> residentMegabytes()
+{
+    ifstream status("/proc/self/status");
+    string line;
+    double current = -1, peak = -1;
+    while (getline(status, line))
+    {
+        if (line.compare(0, 6, "VmRSS:") == 0)
+            current = stod(line.substr(6)) / 1024;
+        else if (line.compare(0, 6, "VmHWM:") == 0)
+            peak = stod(line.substr(6)) / 1024;
+    }
+    if (current < 0 || peak < 0)
+        return nullopt;
+    return make_pair(current, peak);
+}
+
+// Lower the peak reported by residentMegabytes to the current resident set size; false where unsupported
+bool resetPeakResident()
+{
+    ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    clear_refs.close();
+    return static_cast<bool>(clear_refs);
+}
+
+// Throughput, latency quantiles and peak memory of every public analyzer method and of the end-to-end
+// pipeline (analysis plus JSON output) on a seeded synthetic corpus. A row's memory is its peak resident
+// set size above the resident set size when it started (-1 where peaks cannot be reset per row); the
+// peak of the whole run is reported once at the end.
+int runBenchmarkSuite(uint64_t seed, size_t count, size_t min_pages, size_t max_pages, size_t repeat, bool json)
+{
+    vector<string> resumes = generateCorpus(seed, count, min_pages, max_pages);
+    ResumeGenerator job_generator(seed + 1);
+    const size_t job_sizes[] = {5, 50, 500};
+    vector<vector<string>> job_skills;
+    vector<unique_ptr<JobProfile>> jobs;
+    for (size_t size : job_sizes)
+    {
+        job_skills.push_back(job_generator.jobSkills(size));
+        jobs.push_back(make_unique<JobProfile>(job_skills.back(), size == 50));
+    }
+    size_t corpus_bytes = 0;
+    uint64_t corpus_hash = 0;
+    for (const auto &resume : resumes)
+    {
+        corpus_bytes += resume.size();
+        corpus_hash = corpus_hash * 31 + contentHash(resume);
+    }
+
+    ResumeAnalyzer analyzer;
+    size_t checksum = 0;
+    string out;
+    char line[256];
+    if (json)
+        snprintf(line, sizeof(line), "{\"seed\":%llu,\"resumes\":%zu,\"bytes\":%zu,\"corpus_hash\":\"%016llx\",\"benchmarks\":[",
+                 static_cast<unsigned long long>(seed), resumes.size(), corpus_bytes,
+                 static_cast<unsigned long long>(corpus_hash));
+    else
+        snprintf(line, sizeof(line), "Seed %llu: %zu resumes, %.2f MB, corpus hash %016llx\n%-36s %10s %8s %10s %10s %9s\n",
+                 static_cast<unsigned long long>(seed), resumes.size(), corpus_bytes / 1e6,
+                 static_cast<unsigned long long>(corpus_hash), "benchmark", "docs/s", "MB/s", "p50_us", "p99_us",
+                 "+peak_MB");
+    out += line;
+    bool first = true;
+    double run_peak = peakMemoryMegabytes();
+    auto measure = [&](const string &name, auto body)
+    {
+        bool reset = resetPeakResident();
+        optional<pair<double, double>> start_memory = residentMegabytes();
+        auto histogram = make_unique<LatencyHistogram>();
+        auto start = chrono::steady_clock::now();
+        for (size_t round = 0; round < repeat; round++)
+            for (const auto &resume : resumes)
             {
-                if (!trimmed.empty())
-                    current_entry.push_back(trimmed);
-                inProjectSection = true;
-                continue;
+                auto before = chrono::steady_clock::now();
+                checksum += body(resume);
+                histogram->record(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - before).count());
             }
-            if (inProjectSection)
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        double seconds = max(elapsed.count(), 1e-9);
+        vector<uint64_t> counts(LatencyHistogram::bucket_count);
+        histogram->addTo(counts);
+        uint64_t samples = resumes.size() * repeat;
+        double docs = samples / seconds, megabytes = corpus_bytes * repeat / 1e6 / seconds;
+        double p50 = histogramQuantile(counts, samples, 0.5) / 1e3, p99 = histogramQuantile(counts, samples, 0.99) / 1e3;
+        optional<pair<double, double>> end_memory = residentMegabytes();
+        double peak_delta = -1;
+        if (reset && start_memory && end_memory)
+        {
+            peak_delta = max(0.0, end_memory->second - start_memory->first);
+            run_peak = max(run_peak, end_memory->second);
+        }
+        if (json)
+            snprintf(line, sizeof(line),
+                     "%s{\"name\":\"%s\",\"docs_per_s\":%.1f,\"mb_per_s\":%.2f,\"p50_us\":%.3f,\"p99_us\":%.3f,\"peak_delta_mb\":%.1f}",
+                     first ? "" : ",", name.c_str(), docs, megabytes, p50, p99, peak_delta);
+        else
+            snprintf(line, sizeof(line), "%-36s %10.0f %8.2f %10.3f %10.3f %9.1f\n", name.c_str(), docs, megabytes,
+                     p50, p99, peak_delta);
+        out += line;
+        first = false;
+    };
+
+    measure("extractPersonalInfo", [&](const string &resume)
+            { return analyzer.extractPersonalInfo(resume).email.size(); });
+    measure("checkResumeSections", [&](const string &resume)
+            { return size_t(analyzer.checkResumeSections(resume)); });
+    measure("checkFormatting", [&](const string &resume)
+            { return size_t(analyzer.checkFormatting(resume).first); });
+    measure("extractEducation", [&](const string &resume)
+            { return analyzer.extractEducation(resume).size(); });
+    measure("extractExperience", [&](const string &resume)
+            { return analyzer.extractExperience(resume).size(); });
+    measure("extractProjects", [&](const string &resume)
+            { return analyzer.extractProjects(resume).size(); });
+    measure("extractSections", [&](const string &resume)
+            { return analyzer.extractSections(resume).projects.size(); });
+    for (size_t j = 0; j < jobs.size(); j++)
+    {
+        string skills = " (" + to_string(job_sizes[j]) + " skills)";
+        measure("calculateKeywordMatch" + skills, [&](const string &resume)
+                { return analyzer.calculateKeywordMatch(resume, job_skills[j]).found_skills.size(); });
+        measure("analyzeResume" + skills, [&](const string &resume)
+                { return size_t(analyzer.analyzeResume(resume, job_skills[j], job_sizes[j] == 50).ats_score); });
+        measure("analyzeResume, JobProfile" + skills, [&](const string &resume)
+                { return size_t(analyzer.analyzeResume(resume, *jobs[j]).ats_score); });
+    }
+    string record;
+    measure("end to end, JSON output (50 skills)", [&](const string &resume)
             {
-                bool hitOtherSection = false;
-                for (auto &kw : file)
-                {
-                    if (lower_ln.find(kw) != string::npos)
-                    {
-                        hitOtherSection = true;
-                        break;
-                    }
-                }
-                if (hitOtherSection)
-                {
-                    inProjectSection = false;
-                    if (!current_entry.empty())
-                    {
-                        ostringstream oss;
-                        for (auto &part : current_entry)
-                            oss << part << " ";
-                        projects.push_back(oss.str());
-                        current_entry.clear();
-                    }
-                    continue;
-                }
-                if (!trimmed.empty())
-                    current_entry.push_back(trimmed);
-                else if (!current_entry.empty())
-                {
-                    ostringstream oss;
-                    for (auto &part : current_entry)
-                        oss << part << " ";
-                    projects.push_back(oss.str());
-                    current_entry.clear();
-                }
-            }
+                record.clear();
+                appendResultJson(record, "resume", analyzer.analyzeResume(resume, *jobs[1]));
+                return record.size(); });
+    run_peak = max(run_peak, peakMemoryMegabytes());
+    if (json)
+        snprintf(line, sizeof(line), "],\"peak_mb\":%.1f,\"checksum\":%zu}\n", run_peak, checksum);
+    else
+        snprintf(line, sizeof(line), "Peak memory of the run: %.1f MB\nChecksum: %zu\n", run_peak, checksum);
+    out += line;
+    cout << out;
+    return 0;
+}
+
+// Type into a generated resume one keystroke at a time, re-scoring after each through an edit session and
+// through a full analyzeResume, and compare their latency; the two results must agree at every step
+int runEditBenchmark(uint64_t seed, size_t pages, size_t keystrokes)
+{
+    ResumeAnalyzer analyzer;
+    ResumeGenerator generator(seed);
+    JobProfile job(generator.jobSkills(50), true);
+    ResumeEditSession session(analyzer, job, generator.resume(pages));
+    SplitMix64 rng(seed + 1);
+    auto incremental = make_unique<LatencyHistogram>(), full = make_unique<LatencyHistogram>();
+    const string typed = "Improved the build with C++ and SQL, 2021\n";
+    size_t cursor = session.text().size() / 2;
+    string expected_json, actual_json;
+    for (size_t i = 0; i < keystrokes; i++)
+    {
+        // Mostly typing at the cursor, sometimes a backspace or a jump elsewhere
+        if (rng.chance(0.02))
+            cursor = rng.below(session.text().size() + 1);
+        size_t pos = cursor, length = 0;
+        string_view replacement;
+        if (rng.chance(0.15) && cursor > 0)
+        {
+            pos = --cursor;
+            length = 1;
+        }
+        else
+        {
+            replacement = string_view(typed).substr(i % typed.size(), 1);
+            cursor++;
         }
-        if (!current_entry.empty())
+        auto start = chrono::steady_clock::now();
+        session.edit(pos, length, replacement);
+        ResumeAnalysisResult result = session.score();
+        auto middle = chrono::steady_clock::now();
+        ResumeAnalysisResult expected = analyzer.analyzeResume(session.text(), job);
+        auto end = chrono::steady_clock::now();
+        incremental->record(chrono::duration_cast<chrono::nanoseconds>(middle - start).count());
+        full->record(chrono::duration_cast<chrono::nanoseconds>(end - middle).count());
+        actual_json.clear();
+        expected_json.clear();
+        appendResultJson(actual_json, "", result);
+        appendResultJson(expected_json, "", expected);
+        if (actual_json != expected_json || result.education != expected.education ||
+            result.experience != expected.experience || result.projects != expected.projects)
         {
-            ostringstream oss;
-            for (auto &part : current_entry)
-                oss << part << " ";
-            projects.push_back(oss.str());
+            cerr << "Edit session result differs from analyzeResume after keystroke " << i << "\n";
+            return 1;
         }
-        return projects;
     }
+    auto report = [&](const char *name, const LatencyHistogram &histogram)
+    {
+        vector<uint64_t> counts(LatencyHistogram::bucket_count);
+        histogram.addTo(counts);
+        double p50 = histogramQuantile(counts, keystrokes, 0.5) / 1e3, p99 = histogramQuantile(counts, keystrokes, 0.99) / 1e3;
+        cout << name << ": p50 " << p50 << " us, p99 " << p99 << " us\n";
+        return p50;
+    };
+    cout << keystrokes << " keystrokes on a " << session.text().size() << " byte resume, " << job.skills().skills().size()
+         << " job skills\n";
+    double after = report("Edit session re-score", *incremental);
+    double before = report("Full analyzeResume   ", *full);
+    cout << "Median speedup: " << before / after << "x; results identical\n";
+    return 0;
+}
 
-    // Perform the overall resume analysis given the raw text and job requirements (required skills, GPA requirement, etc.)
-    ResumeAnalysisResult analyzeResume(const string &raw_text, const vector<string> &required_skills, bool require_gpa = false)
+// Count the skills one generated resume has of many generated jobs, first with a compiled SkillMatcher per
+// job and then by reducing the resume to a SkillSet once and intersecting it with each job's bitset. Neither
+// side builds the found/missing lists; they are decoded afterwards, untimed, to check both sides agree.
+int runJobMatchBenchmark(uint64_t seed, size_t job_count, size_t pages)
+{
+    ResumeGenerator generator(seed);
+    SplitMix64 sizes(seed + 1);
+    string resume = generator.resume(pages);
+    vector<vector<string>> job_skills;
+    for (size_t j = 0; j < job_count; j++)
+        job_skills.push_back(generator.jobSkills(sizes.between(5, 50)));
+    vector<SkillMatcher> matchers;
+    SkillDictionary dictionary;
+    vector<SkillJob> jobs;
+    for (const auto &skills : job_skills)
     {
-        ResumeAnalysisResult result;
-        result.personal_info = extractPersonalInfo(raw_text);
+        matchers.emplace_back(skills);
+        jobs.emplace_back(dictionary, skills);
+    }
+    dictionary.compile();
 
-        result.keyword_match = calculateKeywordMatch(raw_text, required_skills);
-        result.education = extractEducation(raw_text);
-        result.experience = extractExperience(raw_text);
-        result.projects = extractProjects(raw_text);
+    auto seconds = [](auto start)
+    {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+    size_t matcher_total = 0, bitset_total = 0;
+    vector<size_t> counts(matchers.size());
+    auto start = chrono::steady_clock::now();
+    for (size_t j = 0; j < matchers.size(); j++)
+    {
+        ScratchScope scratch;
+        counts[j] = matchers[j].countMatches(resume, scratch.resource());
+    }
+    double matcher_seconds = seconds(start);
+    for (size_t count : counts)
+        matcher_total += count;
 
-        result.section_score = checkResumeSections(raw_text);
-        auto formatResult = checkFormatting(raw_text);
-        result.format_score = formatResult.first;
-        vector<string> format_deductions = formatResult.second;
+    start = chrono::steady_clock::now();
+    SkillSet found = dictionary.scan(resume);
+    double scan_seconds = seconds(start);
+    vector<int> scores(jobs.size());
+    for (size_t j = 0; j < jobs.size(); j++)
+    {
+        size_t count = jobs[j].countMatches(found);
+        bitset_total += count;
+        scores[j] = skillsScore(count, jobs[j].skills().size());
+    }
+    double bitset_seconds = seconds(start);
 
-        // Generate suggestions for contact information
-        vector<string> contact_suggestions;
-        if (result.personal_info.email.empty())
-            contact_suggestions.push_back("Add your email address");
-        if (result.personal_info.phone.empty())
-            contact_suggestions.push_back("Add your phone number");
-        if (result.personal_info.linkedin.empty())
-            contact_suggestions.push_back("Add your LinkedIn profile URL");
+    for (size_t j = 0; j < jobs.size(); j++)
+    {
+        KeywordMatchResult expected = matchers[j].match(resume), decoded = jobs[j].decode(found);
+        if (scores[j] != matchers[j].scoreFor(counts[j]) || expected.found_skills.size() != counts[j] ||
+            decoded.found_skills != expected.found_skills || decoded.missing_skills != expected.missing_skills ||
+            decoded.score != expected.score)
+        {
+            cerr << "Bitset match differs from SkillMatcher for job " << j << "\n";
+            return 1;
+        }
+    }
+    cout << "1 resume (" << resume.size() << " bytes) x " << jobs.size() << " jobs, " << dictionary.size()
+         << " distinct skills, " << found.size() << " found in the resume\n";
+    cout << "SkillMatcher count/job: " << matcher_seconds * 1e3 << " ms (" << matcher_seconds * 1e9 / jobs.size()
+         << " ns/job)\n";
+    cout << "Scan once + popcount:   " << bitset_seconds * 1e3 << " ms (scan " << scan_seconds * 1e6 << " us, "
+         << (bitset_seconds - scan_seconds) * 1e9 / jobs.size() << " ns/job)\n";
+    cout << "Speedup: " << matcher_seconds / bitset_seconds << "x; " << matcher_total << " matches either way\n";
+    return matcher_total == bitset_total ? 0 : 1;
+}
 
-        // Generate suggestions for skills section
-        vector<string> skills_suggestions;
-        if (!result.keyword_match.missing_skills.empty())
+// Score generated resumes of 1, 4 and pages pages when only the ATS score is wanted: the full analysis,
+// atsScoreOnly and a LazyResumeAnalysis read for its score alone, checking all agree and that the lazy
+// handle's complete result matches analyzeResume
+int runScoreOnlyBenchmark(uint64_t seed, size_t count, size_t pages, size_t repeat)
+{
+    ResumeAnalyzer analyzer;
+    ResumeGenerator generator(seed);
+    JobProfile job(generator.jobSkills(30), true);
+    size_t mismatches = 0;
+    for (size_t size : {size_t(1), size_t(4), pages})
+    {
+        vector<string> resumes;
+        for (size_t i = 0; i < count; i++)
+            resumes.push_back(generator.resume(size));
+        for (const auto &resume : resumes)
+        {
+            string expected, actual, after_score;
+            appendResultJson(expected, "", analyzer.analyzeResume(resume, job));
+            appendResultJson(actual, "", LazyResumeAnalysis(analyzer, resume, job).result());
+            // The complete result read after the score, from the pieces the score kept
+            LazyResumeAnalysis scored(analyzer, resume, job);
+            scored.atsScore();
+            appendResultJson(after_score, "", scored.result());
+            mismatches += expected != actual || expected != after_score || analyzer.atsScoreOnly(resume, job) != analyzer.analyzeResume(resume, job).ats_score;
+        }
+        // Best of repeat runs of each way of getting the scores, in microseconds per resume, and the scores' sum
+        auto measure = [&](auto score)
         {
-            skills_suggestions.push_back("Mising skills are: ");
-            for (auto &it : result.keyword_match.missing_skills)
+            double best = 1e300;
+            long checksum = 0;
+            for (size_t r = 0; r < repeat; r++)
             {
-                skills_suggestions.push_back(it);
+                checksum = 0;
+                auto start = chrono::steady_clock::now();
+                for (const auto &resume : resumes)
+                    checksum += score(resume);
+                best = min(best, chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
             }
-        }
+            return make_pair(best / resumes.size(), checksum);
+        };
+        auto [full, full_sum] = measure([&](const string &resume)
+                                        { return analyzer.analyzeResume(resume, job).ats_score; });
+        auto [fast, fast_sum] = measure([&](const string &resume)
+                                        { return analyzer.atsScoreOnly(resume, job); });
+        auto [lazy, lazy_sum] = measure([&](const string &resume)
+                                        { return LazyResumeAnalysis(analyzer, resume, job).atsScore(); });
+        mismatches += (fast_sum != full_sum) + (lazy_sum != full_sum);
+        printf("%2zu page(s): analyzeResume %8.1f us, atsScoreOnly %8.1f us (%.2fx), lazy atsScore %8.1f us (%.2fx)\n",
+               size, full, fast, full / fast, lazy, full / lazy);
+    }
+    cout << (mismatches == 0 ? "All scores and lazy results identical to analyzeResume\n"
+                             : to_string(mismatches) + " resume(s) differ from analyzeResume\n");
+    return mismatches == 0 ? 0 : 1;
+}
 
-        // Generate suggestions for experience section
-        vector<string> experience_suggestions;
-        if (result.experience.empty())
+// Analyze a long generated CV and a dump of many concatenated resumes, each of about pages pages, once on
+// the single-threaded path and once split into chunks on a pool, checking both give the same result
+int runLargeDocumentBenchmark(uint64_t seed, size_t pages, size_t threads, size_t repeat)
+{
+    ResumeAnalyzer analyzer;
+    ResumeGenerator generator(seed);
+    SplitMix64 sizes(seed + 1);
+    JobProfile job(generator.jobSkills(40), true);
+    string long_cv = generator.resume(pages), dump;
+    while (dump.size() < pages * ResumeGenerator::bytes_per_page)
+        dump += generator.resume(sizes.between(1, 3)) + "\n";
+    WorkStealingPool pool(threads);
+    // A phone number at the very start of the second chunk, where \s* lets the match begin at the '\n'
+    // ending the first
+    string boundary;
+    while (boundary.size() < max(pages * ResumeGenerator::bytes_per_page, 2 * ResumeAnalyzer::parallel_analysis_bytes))
+        boundary += "Led the migration of billing services to an event driven design\n";
+    vector<pair<size_t, size_t>> chunks = ResumeAnalyzer::analysisChunks(boundary, pool.size());
+    if (chunks.size() > 1)
+        boundary.replace(chunks[1].first, 12, "555-123-4567");
+    cout << "Documents of " << ResumeAnalyzer::parallel_analysis_bytes / 1024
+         << " KB or more are split into chunks on " << pool.size() << " thread(s)\n";
+    for (auto [name, text] : {pair<const char *, const string &>{"Long CV", long_cv},
+                              {"Resume dump", dump},
+                              {"Phone at a chunk boundary", boundary}})
+    {
+        double serial = 1e30, chunked = 1e30;
+        ResumeAnalysisResult expected, actual;
+        for (size_t r = 0; r < repeat; r++)
         {
-            experience_suggestions.push_back("Add your work experience section");
+            auto start = chrono::steady_clock::now();
+            expected = analyzer.analyzeResume(text, job);
+            auto middle = chrono::steady_clock::now();
+            actual = analyzer.analyzeResume(text, job, pool);
+            auto end = chrono::steady_clock::now();
+            serial = min(serial, chrono::duration<double>(middle - start).count());
+            chunked = min(chunked, chrono::duration<double>(end - middle).count());
         }
-        else
+        string expected_json, actual_json;
+        appendResultJson(expected_json, "", expected);
+        appendResultJson(actual_json, "", actual);
+        if (actual_json != expected_json || actual.education != expected.education ||
+            actual.experience != expected.experience || actual.projects != expected.projects)
+        {
+            cerr << name << ": chunked analysis differs from analyzeResume\n";
+            return 1;
+        }
+        cout << name << " (" << text.size() / 1024 << " KB): single-threaded " << serial * 1e3 << " ms, chunked "
+             << chunked * 1e3 << " ms, speedup " << serial / chunked << "x; results identical\n";
+    }
+    return 0;
+}
+
+// Score a generated corpus of count distinct resumes, each followed by clones with a new name line and
+// a few words edited, in shuffled order: once with a full analysis of every resume and once through a
+// NearDuplicateIndex. Reports how many clones reused an analysis, whether any reused that of another
+// resume's cluster, and how far the reused scores are from the full ones.
+int runDedupBenchmark(uint64_t seed, size_t count, size_t clones, double similarity, size_t capacity)
+{
+    ResumeAnalyzer analyzer;
+    ResumeGenerator generator(seed);
+    SplitMix64 rng(seed + 1);
+    JobProfile job(generator.jobSkills(30), true);
+    const vector<string> &skills = ResumeGenerator::skillPool();
+    vector<string> texts;
+    vector<size_t> origin;
+    for (size_t i = 0; i < count; i++)
+    {
+        string original = generator.resume(rng.between(1, 3));
+        texts.push_back(original);
+        origin.push_back(i);
+        for (size_t c = 0; c < clones; c++)
         {
-            bool has_dates = false, has_bullets = false, has_action_verbs = false;
-            regex date_pattern(R"(\b(19|20)\d{2}\b)");
-            regex bullet_pattern(R"([•\-\*])");
-            regex action_verbs(R"(\b(developed|managed|created|implemented|designed|led|improved)\b)");
-            for (auto &exp : result.experience)
+            string clone = "Candidate " + to_string(rng.below(1000000)) + original.substr(original.find('\n'));
+            for (size_t k = 0; k < clone.size() / 800; k++)
             {
-                if (regex_search(exp, date_pattern))
-                    has_dates = true;
-                if (regex_search(exp, bullet_pattern))
-                    has_bullets = true;
-                if (regex_search(toLower(exp), action_verbs))
-                    has_action_verbs = true;
+                // Replace a word here and there
+                size_t pos = clone.find(' ', rng.below(clone.size()));
+                if (pos == string::npos)
+                    continue;
+                size_t end = clone.find_first_of(" \n", pos + 1);
+                clone.replace(pos + 1, (end == string::npos ? clone.size() : end) - pos - 1, rng.pick(skills));
             }
-            if (!has_dates)
-                experience_suggestions.push_back("Include dates for each work experience");
-            if (!has_bullets)
-                experience_suggestions.push_back("Use bullet points to list your achievements and responsibilities");
-            if (!has_action_verbs)
-                experience_suggestions.push_back("Start bullet points with strong action verbs");
+            texts.push_back(move(clone));
+            origin.push_back(i);
         }
+    }
+    vector<size_t> order(texts.size());
+    for (size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    for (size_t i = order.size() - 1; i > 0; i--)
+        swap(order[i], order[rng.below(i + 1)]);
+
+    auto start = chrono::steady_clock::now();
+    vector<ResumeAnalysisResult> full(texts.size());
+    for (size_t i : order)
+        full[i] = analyzer.analyzeResume(texts[i], job);
+    double full_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
 
-        // Generate suggestions for education section
-        vector<string> education_suggestions;
-        if (result.education.empty())
+    NearDuplicateIndex index(similarity, capacity);
+    start = chrono::steady_clock::now();
+    vector<ResumeAnalysisResult> deduplicated(texts.size());
+    for (size_t i : order)
+        deduplicated[i] = analyzer.analyzeResume(texts[i], job, index);
+    double dedup_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Which cluster each analysis came from, found by replaying the lookups
+    NearDuplicateIndex replay(similarity, capacity);
+    unordered_map<const DocumentAnalysis *, size_t> representative_origin;
+    size_t reused = 0, foreign = 0, changed = 0;
+    double score_error = 0;
+    for (size_t i : order)
+    {
+        NearDuplicateIndex::Signature signature = *NearDuplicateIndex::signatureOf(texts[i]);
+        shared_ptr<const DocumentAnalysis> analysis = replay.find(signature);
+        if (!analysis)
         {
-            education_suggestions.push_back("Add your educational background");
+            analysis = make_shared<const DocumentAnalysis>();
+            replay.insert(signature, analysis);
+            representative_origin[analysis.get()] = origin[i];
+            continue;
         }
-        else
-        {
-            bool has_dates = false, has_degree = false, has_gpa = false;
-            regex date_pattern(R"(\b(19|20)\d{2}\b)");
-            regex degree_pattern(R"(\b(bachelor|master|phd|b\.|m\.|diploma)\b)");
-            regex gpa_pattern(R"(\b(gpa|cgpa|grade|percentage)\b)");
-            for (auto &edu : result.education)
+        reused++;
+        foreign += representative_origin[analysis.get()] != origin[i];
+        changed += deduplicated[i].ats_score != full[i].ats_score;
+        score_error += abs(deduplicated[i].ats_score - full[i].ats_score);
+    }
+    NearDuplicateIndex::Stats stats = index.stats();
+    cout << texts.size() << " resumes: " << count << " originals with " << clones << " clone(s) each, similarity "
+         << similarity << "\n";
+    cout << "Full analysis:    " << full_seconds * 1e3 << " ms (" << texts.size() / full_seconds << " docs/s)\n";
+    cout << "Near-duplicates:  " << dedup_seconds * 1e3 << " ms (" << texts.size() / dedup_seconds << " docs/s), "
+         << stats.comparisons / double(texts.size()) << " signature comparisons per resume\n";
+    cout << "Index:            " << stats.representatives << " representatives kept of at most " << capacity << ", "
+         << stats.evicted << " evicted, " << stats.truncated_walks << " bucket walks cut off after "
+         << NearDuplicateIndex::max_bucket_walk << "\n";
+    cout << "Reused " << reused << " of " << count * clones << " clone analyses, " << foreign
+         << " from another resume's cluster; " << changed << " ATS score(s) changed, mean absolute change "
+         << (reused ? score_error / reused : 0) << "\n";
+    return foreign == 0 ? 0 : 1;
+}
+
+// Pattern work done per resume before the scanners: every regex compiled on each call
+size_t legacyPatternPass(const string &text)
+{
+    regex strict_email(R"(\b[\w\.-]+@[\w\.-]+\.\w+\b)");
+    regex strict_phone(R"(\b\d{3}[-.]?\d{3}[-.]?\d{4}\b)");
+    regex linkedin_any(R"(linkedin\.com/\w+)");
+    regex email_pattern(R"([\w\.-]+@[\w\.-]+\.\w+)");
+    regex phone_pattern(R"((\+\d{1,3}[-.]?)?\s*\(?\d{3}\)?[-.]?\s*\d{3}[-.]?\s*\d{4})");
+    regex linkedin_pattern(R"(linkedin\.com/in/[\w-]+)");
+    regex github_pattern(R"(github\.com/[\w-]+)");
+    regex codeforces_pattern(R"(codeforces\.com/profile/[\w-]+)");
+    regex date_pattern(R"(\b(19|20)\d{2}\b)");
+    regex bullet_pattern(R"([•\-\*])");
+    regex action_verbs(R"(\b(developed|managed|created|implemented|designed|led|improved)\b)");
+    regex degree_pattern(R"(\b(bachelor|master|phd|b\.|m\.|diploma)\b)");
+    regex gpa_pattern(R"(\b(gpa|cgpa|grade|percentage)\b)");
+    size_t hits = regex_search(text, strict_email) + regex_search(text, strict_phone) + regex_search(text, linkedin_any);
+    smatch match;
+    for (const regex *pattern : {&email_pattern, &phone_pattern, &linkedin_pattern, &github_pattern, &codeforces_pattern})
+        if (regex_search(text, match, *pattern))
+            hits += match.length(0);
+    string lower_text = toLower(text);
+    for (const regex *pattern : {&date_pattern, &bullet_pattern, &action_verbs, &degree_pattern, &gpa_pattern})
+        hits += regex_search(lower_text, *pattern);
+    return hits;
+}
+
+// The same pattern work using the linear scanners
+size_t scannerPatternPass(const string &text)
+{
+    size_t hits = !scanEmail(text, true).empty() + containsPlainPhone(text) +
+                  !scanProfileUrl(text, "linkedin.com/", false).empty();
+    hits += scanEmail(text).size() + scanPhone(text).size() + scanProfileUrl(text, "linkedin.com/in/").size() +
+            scanProfileUrl(text, "github.com/").size() + scanProfileUrl(text, "codeforces.com/profile/").size();
+    string lower_text = toLower(text);
+    hits += containsYear(lower_text) + containsBulletMark(lower_text) + containsActionVerb(lower_text) +
+            containsDegree(lower_text) + containsGpaMention(lower_text);
+    return hits;
+}
+
+// Time the per-resume pattern work with std::regex and with the scanners over `documents` copies of text
+int runPatternBenchmark(const string &text, size_t documents)
+{
+    if (legacyPatternPass(text) != scannerPatternPass(text))
+    {
+        cerr << "Pattern benchmark: scanner results differ from std::regex\n";
+        return 1;
+    }
+    auto measure = [&](auto pass)
+    {
+        size_t checksum = 0;
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < documents; i++)
+            checksum += pass();
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        return make_pair(elapsed.count(), checksum);
+    };
+    auto before = measure([&]
+                          { return legacyPatternPass(text); });
+    auto after = measure([&]
+                         { return scannerPatternPass(text); });
+    cout << "Documents: " << documents << "\n";
+    cout << "Per-call regex construction: " << before.first << " s (" << before.first * 1e6 / documents << " us/doc)\n";
+    cout << "Linear scanners:             " << after.first << " s (" << after.first * 1e6 / documents << " us/doc)\n";
+    cout << "Speedup: " << before.first / after.first << "x\n";
+    return before.second == after.second ? 0 : 1;
+}
+
+// Check that the per-resume hot path makes a small number of heap allocations that does not grow with the text
+int runAllocationCheck(const string &text, const vector<string> &required_skills)
+{
+    const size_t max_allocations = 32;
+    ResumeAnalyzer analyzer;
+    JobProfile job(required_skills, true);
+    auto allocationsFor = [&](const string &resume)
+    {
+        size_t before = heap_allocations;
+        ResumeAnalysisResult result = analyzer.analyzeResume(resume, job);
+        return heap_allocations - before;
+    };
+    // Extra lines continue the last entry, so the result holds the same number of strings at every size
+    auto withExtraLines = [&](size_t count)
+    {
+        string resume = text;
+        for (size_t i = 0; i < count; i++)
+            resume += "\n- Implemented a caching layer in C++ that cut p99 latency by 40 percent";
+        return resume;
+    };
+    bool ok = true;
+    allocationsFor(text); // warm up function-local statics
+    size_t baseline = allocationsFor(withExtraLines(10));
+    for (size_t lines : {10, 1000, 10000})
+    {
+        string resume = withExtraLines(lines);
+        allocationsFor(resume); // let the thread's scratch arena grow to this size
+        size_t allocations = allocationsFor(resume);
+        cout << "analyzeResume with " << lines << " extra lines: " << allocations << " heap allocations\n";
+        ok = ok && allocations == baseline && allocations <= max_allocations;
+    }
+    // A resume too large for the arena to keep: its scratch memory goes back to the heap after use
+    allocationsFor(withExtraLines(100000));
+    size_t kept = ScratchArena::local().bufferSize();
+    cout << "Scratch buffer after 100000 extra lines: " << kept / 1024 << " KB (limit "
+         << ScratchArena::max_retained / 1024 << " KB)\n";
+    ok = ok && kept <= ScratchArena::max_retained;
+    cout << (ok ? "PASS" : "FAIL") << ": bound " << max_allocations << " allocations per resume\n";
+    return ok ? 0 : 1;
+}
+
+// Score variants of text against a few jobs on one thread and on every core, checking the results agree
+int runBatchBenchmark(const string &text, size_t resume_count, size_t threads)
+{
+    ResumeAnalyzer analyzer;
+    vector<string> resumes;
+    for (size_t i = 0; i < resume_count; i++)
+        resumes.push_back(text + "\nSKILLS\n" + (i % 2 ? "SQL, Kafka" : "Java, Docker") + " " + to_string(i));
+    vector<JobRequirements> jobs(3);
+    jobs[0].required_skills = {"C++", "Python", "SQL", "Java"};
+    jobs[0].require_gpa = true;
+    jobs[1].required_skills = {"Java", "Spring", "Kafka"};
+    jobs[2].required_skills = {"Python", "Docker", "Kubernetes", "SQL", "Vue"};
+    auto timed = [&](size_t thread_count)
+    {
+        WorkStealingPool pool(thread_count);
+        auto start = chrono::steady_clock::now();
+        auto results = analyzer.analyzeBatch(resumes, jobs, pool);
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        cout << pool.size() << " thread(s): " << elapsed.count() << " s, "
+             << resumes.size() * jobs.size() / elapsed.count() << " scores/s\n";
+        return results;
+    };
+    auto serial = timed(1);
+    auto parallel = timed(threads);
+    for (size_t r = 0; r < resumes.size(); r++)
+        for (size_t j = 0; j < jobs.size(); j++)
+            if (serial[r][j].ats_score != parallel[r][j].ats_score ||
+                serial[r][j].suggestions != parallel[r][j].suggestions)
             {
-                if (regex_search(edu, date_pattern))
-                    has_dates = true;
-                if (regex_search(toLower(edu), degree_pattern))
-                    has_degree = true;
-                if (regex_search(toLower(edu), gpa_pattern))
-                    has_gpa = true;
+                cerr << "Batch results differ for resume " << r << ", job " << j << "\n";
+                return 1;
+            }
+    cout << "Results identical across thread counts\n";
+    return 0;
+}
+
+// Measure each text kernel set on size bytes of resume-like text, checking they all agree with the scalar set
+int runKernelBenchmark(const string &text, size_t size)
+{
+    string mixed, spaces(size, ' '), upper;
+    while (mixed.size() < size)
+        mixed += text;
+    mixed.resize(size);
+    upper = mixed;
+    for (char &c : upper)
+        if (c >= 'a' && c <= 'z')
+            c -= 32;
+    spaces.back() = 'x';
+    spaces.front() = 'x';
+    // Small unaligned slices exercise the vector loops and the scalar tails together
+    auto agrees = [&](const TextKernels &kernels)
+    {
+        const TextKernels &scalar = availableTextKernels().front();
+        string expected, actual;
+        for (size_t offset = 0; offset < 97; offset++)
+            for (size_t length : {size_t(0), size_t(1), size_t(15), size_t(33), size_t(70), size_t(257)})
+            {
+                const char *source[] = {mixed.data() + offset, upper.data() + offset, spaces.data() + offset};
+                for (const char *data : source)
+                {
+                    expected.assign(length, '\0');
+                    actual.assign(length, '\0');
+                    scalar.to_lower(data, expected.data(), length);
+                    kernels.to_lower(data, actual.data(), length);
+                    if (expected != actual || scalar.find_byte(data, length, '\n') != kernels.find_byte(data, length, '\n') ||
+                        scalar.skip_spaces(data, length) != kernels.skip_spaces(data, length) ||
+                        scalar.skip_spaces_back(data, length) != kernels.skip_spaces_back(data, length) ||
+                        scalar.has_lowercase(data, length) != kernels.has_lowercase(data, length))
+                        return false;
+                }
             }
-            if (!has_dates)
-                education_suggestions.push_back("Include graduation dates");
-            if (!has_degree)
-                education_suggestions.push_back("Specify your degree type");
-            if (!has_gpa && require_gpa)
-                education_suggestions.push_back("Include your CGPA if it's above 7.0");
+        return true;
+    };
+    size_t checksum = 0;
+    auto gigabytesPerSecond = [&](auto pass)
+    {
+        const int rounds = 5;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++)
+            checksum += pass();
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        return rounds * double(size) / elapsed.count() / 1e9;
+    };
+    string lowered(size, '\0');
+    cout << "Buffer: " << size << " bytes, GB/s per kernel\n";
+    cout << "kernels  to_lower  find_newline  trim  has_lowercase\n";
+    for (const TextKernels &kernels : availableTextKernels())
+    {
+        if (!agrees(kernels))
+        {
+            cerr << "Kernel benchmark: " << kernels.name << " results differ from scalar\n";
+            return 1;
         }
+        double lower = gigabytesPerSecond([&]
+                                          { kernels.to_lower(mixed.data(), lowered.data(), size); return size_t(lowered[size / 2]); });
+        double newline = gigabytesPerSecond([&]
+                                            {
+                                                size_t lines = 0;
+                                                for (size_t pos = 0; pos < size; pos++, lines++)
+                                                    pos += kernels.find_byte(mixed.data() + pos, size - pos, '\n');
+                                                return lines; });
+        // Trimming a run of blanks reads it once from each end
+        double trim = gigabytesPerSecond([&]
+                                         { return kernels.skip_spaces(spaces.data() + 1, size - 1) +
+                                                  kernels.skip_spaces_back(spaces.data(), size - 1); }) * 2;
+        double lowercase = gigabytesPerSecond([&]
+                                              { return size_t(kernels.has_lowercase(upper.data(), size)); });
+        printf("%-7s  %8.2f  %12.2f  %4.2f  %13.2f\n", kernels.name, lower, newline, trim, lowercase);
+    }
+    cout << "Analyzer uses: " << textKernels().name << " (checksum " << checksum << ")\n";
+    return 0;
+}
 
-        // Formatting suggestions
-        vector<string> format_suggestions;
-        if (result.format_score < 100)
-            format_suggestions = format_deductions;
-
-        int contact_score = 100 - (contact_suggestions.size() * 25);
-
-        int skills_score = static_cast<int>(result.keyword_match.score);
-        int experience_score = 100 - (experience_suggestions.size() * 25);
-        int education_score = 100 - (education_suggestions.size() * 25);
-
-        int ats_score = static_cast<int>(round(contact_score * 0.1)) +
-                        static_cast<int>(round(skills_score * 0.35)) +
-                        static_cast<int>(round(experience_score * 0.25)) +
-                        static_cast<int>(round(education_score * 0.1)) +
-                        static_cast<int>(round(result.format_score * 0.2));
-        result.ats_score = ats_score;
-
-        // Combine all suggestions
-        result.suggestions.insert(result.suggestions.end(), contact_suggestions.begin(), contact_suggestions.end());
-        result.suggestions.insert(result.suggestions.end(), skills_suggestions.begin(), skills_suggestions.end());
-        result.suggestions.insert(result.suggestions.end(), experience_suggestions.begin(), experience_suggestions.end());
-        result.suggestions.insert(result.suggestions.end(), education_suggestions.begin(), education_suggestions.end());
-        result.suggestions.insert(result.suggestions.end(), format_suggestions.begin(), format_suggestions.end());
-        if (result.suggestions.empty())
-            result.suggestions.push_back("Your resume is well-optimized for ATS systems");
-
-        result.section_scores["contact"] = contact_score;
-        result.section_scores["skills"] = skills_score;
-        result.section_scores["experience"] = experience_score;
-        result.section_scores["education"] = education_score;
-        result.section_scores["format"] = result.format_score;
+// Value following option name on the command line, or fallback if it is absent
+string optionValue(int argc, char *argv[], const string &name, const string &fallback)
+{
+    for (int i = 1; i + 1 < argc; i++)
+        if (argv[i] == name)
+            return argv[i + 1];
+    return fallback;
+}
 
-        return result;
+bool hasFlag(int argc, char *argv[], const string &name)
+{
+    for (int i = 1; i < argc; i++)
+        if (argv[i] == name)
+            return true;
+    return false;
+}
+
+// True, with the error reported, when --description is given to a mode that builds no corpus of resumes
+// to take the relevance's idf statistics from; only --stream, --pipeline and --rank do
+bool descriptionRejected(int argc, char *argv[])
+{
+    if (!hasFlag(argc, argv, "--description"))
+        return false;
+    cerr << "Error: " << argv[1] << " does not take --description; use --stream, --pipeline or --rank\n";
+    return true;
+}
+
+// Job requirements given as --skills "C++,SQL,...", --gpa and, where with_description allows it,
+// --description <file with the job posting>, defaulting to fallback_skills; nullopt, with the error
+// reported, when the description is not allowed or cannot be read
+optional<JobRequirements> jobFromOptions(int argc, char *argv[], const vector<string> &fallback_skills,
+                                         bool with_description = false)
+{
+    if (!with_description && descriptionRejected(argc, argv))
+        return nullopt;
+    JobRequirements job;
+    string skills = optionValue(argc, argv, "--skills", "");
+    job.required_skills = skills.empty() ? fallback_skills : splitList(skills);
+    job.require_gpa = hasFlag(argc, argv, "--gpa");
+    string description = optionValue(argc, argv, "--description", "");
+    if (!description.empty())
+    {
+        ifstream in(description, ios::binary);
+        if (!in)
+        {
+            cerr << "Error: cannot read job description " << description << "\n";
+            return nullopt;
+        }
+        job.description.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
     }
-};
+    return job;
+}
 
-int main()
+int main(int argc, char *argv[])
 {
     // Demonstration: a sample resume text and required skills
     string resumeText = "Tanmya Potdar\n"
@@ -663,6 +8236,192 @@ int main()
 
     vector<string> required_skills = {"C++", "Python", "SQL", "Java"};
 
+    // --bench-patterns [documents]: compare per-call regex construction against the linear scanners
+    if (argc > 1 && string(argv[1]) == "--bench-patterns")
+        return runPatternBenchmark(resumeText, argc > 2 ? stoul(argv[2]) : 100000);
+    // --check-allocations: verify the per-resume heap allocation count is small and independent of size
+    if (argc > 1 && string(argv[1]) == "--check-allocations")
+        return runAllocationCheck(resumeText, required_skills);
+    // --bench-batch [resumes] [threads]: score a batch against several jobs on a work-stealing pool
+    if (argc > 1 && string(argv[1]) == "--bench-batch")
+        return runBatchBenchmark(resumeText, argc > 2 ? stoul(argv[2]) : 20000,
+                                 argc > 3 ? stoul(argv[3]) : thread::hardware_concurrency());
+    // --bench-kernels [megabytes]: throughput of the scalar, SSE2 and AVX2 text kernels
+    if (argc > 1 && string(argv[1]) == "--bench-kernels")
+        return runKernelBenchmark(resumeText, (argc > 2 ? stoul(argv[2]) : 64) << 20);
+    // --stream <corpus> [--skills a,b,c] [--gpa] [--description F] [--cache N] [--cache-dir D]
+    // [--dedup [--dedup-similarity S] [--dedup-capacity R]] [--store F] [--binary]: score a corpus, one JSON record (or compact
+    // binary entry) per resume on stdout, optionally caching the job-independent analysis of up to N distinct
+    // resumes, sharing it between near-duplicates or keeping it in the analysis store F across runs; with a
+    // job description F, each resume also gets its BM25 relevance to it
+    if (argc > 2 && string(argv[1]) == "--stream")
+    {
+        size_t cache_entries = stoul(optionValue(argc, argv, "--cache", "0"));
+        unique_ptr<AnalysisCache> cache;
+        if (cache_entries > 0)
+            cache = make_unique<AnalysisCache>(cache_entries, optionValue(argc, argv, "--cache-dir", ""));
+        unique_ptr<NearDuplicateIndex> dedup;
+        if (hasFlag(argc, argv, "--dedup"))
+            dedup = make_unique<NearDuplicateIndex>(
+                stod(optionValue(argc, argv, "--dedup-similarity", "0.8")),
+                stoul(optionValue(argc, argv, "--dedup-capacity", to_string(NearDuplicateIndex::default_capacity))));
+        optional<JobRequirements> job = jobFromOptions(argc, argv, required_skills, true);
+        if (!job)
+            return 1;
+        return runStream(argv[2], *job, cache.get(), dedup.get(),
+                         optionValue(argc, argv, "--store", ""),
+                         hasFlag(argc, argv, "--binary"));
+    }
+    // --pipeline <corpus> [--skills a,b,c] [--gpa] [--description F] [--workers N] [--queue Q] [--binary]
+    // [--write-delay-us D]: the --stream output from a pipeline of stages joined by bounded queues
+    if (argc > 2 && string(argv[1]) == "--pipeline")
+    {
+        optional<JobRequirements> job = jobFromOptions(argc, argv, required_skills, true);
+        if (!job)
+            return 1;
+        return runPipeline(argv[2], *job,
+                           stoul(optionValue(argc, argv, "--workers", to_string(thread::hardware_concurrency()))),
+                           stoul(optionValue(argc, argv, "--queue", "64")), hasFlag(argc, argv, "--binary"),
+                           stoul(optionValue(argc, argv, "--write-delay-us", "0")));
+    }
+    // --store-get <store> <id>: the stored analysis of one resume as JSON
+    if (argc > 3 && string(argv[1]) == "--store-get")
+        return runStoreGet(argv[2], argv[3]);
+    // --store-compact <store>: rewrite a store without superseded records
+    if (argc > 2 && string(argv[1]) == "--store-compact")
+        return runStoreCompact(argv[2]);
+    // --export-columns <corpus> <out> [--jobs "a,b;c,d"] [--gpa] [--threads T]: columnar scores of every resume
+    // against each job, defaulting to the --skills job
+    if (argc > 3 && string(argv[1]) == "--export-columns")
+    {
+        if (descriptionRejected(argc, argv))
+            return 1;
+        vector<JobRequirements> jobs;
+        string job_list = optionValue(argc, argv, "--jobs", "");
+        for (auto skills : split(job_list, ';'))
+        {
+            JobRequirements job;
+            job.required_skills = splitList(skills);
+            job.require_gpa = hasFlag(argc, argv, "--gpa");
+            jobs.push_back(move(job));
+        }
+        if (jobs.empty())
+        {
+            optional<JobRequirements> job = jobFromOptions(argc, argv, required_skills);
+            if (!job)
+                return 1;
+            jobs.push_back(move(*job));
+        }
+        return runColumnExport(argv[2], argv[3], jobs,
+                               stoul(optionValue(argc, argv, "--threads", to_string(thread::hardware_concurrency()))));
+    }
+    // --columns-summary <export>: per-job statistics read from a columnar export
+    if (argc > 2 && string(argv[1]) == "--columns-summary")
+        return runColumnSummary(argv[2]);
+    // --rank <corpus> [--skills a,b,c] [--gpa] [--description F] [--top K] [--verify]: best K resumes with early termination
+    if (argc > 2 && string(argv[1]) == "--rank")
+    {
+        optional<JobRequirements> job = jobFromOptions(argc, argv, required_skills, true);
+        if (!job)
+            return 1;
+        return runRanking(argv[2], *job,
+                          stoul(optionValue(argc, argv, "--top", "50")), hasFlag(argc, argv, "--verify"));
+    }
+    // --bench-jobs [--jobs N] [--pages P] [--seed S]: one resume against many jobs, per-job matchers vs skill bitsets
+    if (argc > 1 && string(argv[1]) == "--bench-jobs")
+        return runJobMatchBenchmark(stoull(optionValue(argc, argv, "--seed", "42")),
+                                    stoul(optionValue(argc, argv, "--jobs", "10000")),
+                                    stoul(optionValue(argc, argv, "--pages", "3")));
+    // --bench-score-only [--count N] [--pages P] [--repeat R] [--seed S]: ATS score alone vs the full analysis
+    if (argc > 1 && string(argv[1]) == "--bench-score-only")
+        return runScoreOnlyBenchmark(stoull(optionValue(argc, argv, "--seed", "42")),
+                                     stoul(optionValue(argc, argv, "--count", "500")),
+                                     stoul(optionValue(argc, argv, "--pages", "20")),
+                                     stoul(optionValue(argc, argv, "--repeat", "3")));
+    // --bench-large [--pages P] [--threads T] [--repeat N] [--seed S]: chunked analysis of very large documents
+    if (argc > 1 && string(argv[1]) == "--bench-large")
+        return runLargeDocumentBenchmark(stoull(optionValue(argc, argv, "--seed", "42")),
+                                         stoul(optionValue(argc, argv, "--pages", "60")),
+                                         stoul(optionValue(argc, argv, "--threads", to_string(thread::hardware_concurrency()))),
+                                         stoul(optionValue(argc, argv, "--repeat", "5")));
+    // --bench-dedup [--count N] [--clones C] [--similarity S] [--capacity R] [--seed S]: near-duplicate
+    // reuse vs full analysis
+    if (argc > 1 && string(argv[1]) == "--bench-dedup")
+        return runDedupBenchmark(stoull(optionValue(argc, argv, "--seed", "42")),
+                                 stoul(optionValue(argc, argv, "--count", "2000")),
+                                 stoul(optionValue(argc, argv, "--clones", "4")),
+                                 stod(optionValue(argc, argv, "--similarity", "0.8")),
+                                 stoul(optionValue(argc, argv, "--capacity", to_string(NearDuplicateIndex::default_capacity))));
+    // --bench-edits [--pages P] [--keystrokes N] [--seed S]: re-score latency of an edit session vs analyzeResume
+    if (argc > 1 && string(argv[1]) == "--bench-edits")
+        return runEditBenchmark(stoull(optionValue(argc, argv, "--seed", "42")), stoul(optionValue(argc, argv, "--pages", "3")),
+                                stoul(optionValue(argc, argv, "--keystrokes", "2000")));
+    // --serve <socket> [--workers N] [--skills a,b,c] [--gpa]: score requests sent over a Unix domain socket
+    if (argc > 2 && string(argv[1]) == "--serve")
+    {
+        optional<JobRequirements> job = jobFromOptions(argc, argv, required_skills);
+        if (!job)
+            return 1;
+        return runServer(argv[2], *job,
+                         stoul(optionValue(argc, argv, "--workers", to_string(thread::hardware_concurrency()))));
+    }
+    // --load <socket> <corpus> [--connections C] [--pipeline D] [--requests N] [--skills a,b,c] [--gpa]:
+    // measure a running server's throughput and latency; --skills registers a job instead of using job 0
+    if (argc > 3 && string(argv[1]) == "--load")
+    {
+        optional<JobRequirements> job = jobFromOptions(argc, argv, {});
+        if (!job)
+            return 1;
+        return runLoadGenerator(argv[2], argv[3], hasFlag(argc, argv, "--skills") ? &*job : nullptr,
+                                stoul(optionValue(argc, argv, "--connections", "4")),
+                                stoul(optionValue(argc, argv, "--pipeline", "16")),
+                                stoul(optionValue(argc, argv, "--requests", "100000")));
+    }
+    // --generate <corpus> [--count N] [--seed S] [--pages MIN-MAX]: write a seeded synthetic corpus
+    // (.jsonl, .lp, or a directory of .txt files)
+    // --bench-suite [--count N] [--seed S] [--pages MIN-MAX] [--repeat R] [--json]: benchmark every analyzer
+    // method and the end-to-end pipeline on such a corpus
+    if ((argc > 2 && string(argv[1]) == "--generate") || (argc > 1 && string(argv[1]) == "--bench-suite"))
+    {
+        uint64_t seed = stoull(optionValue(argc, argv, "--seed", "42"));
+        string pages = optionValue(argc, argv, "--pages", "1-20");
+        size_t min_pages = stoul(pages), max_pages = pages.find('-') != string::npos ? stoul(pages.substr(pages.find('-') + 1)) : min_pages;
+        if (min_pages == 0 || max_pages < min_pages)
+        {
+            cerr << "--pages expects MIN-MAX with 1 <= MIN <= MAX\n";
+            return 1;
+        }
+        if (string(argv[1]) == "--generate")
+            return runGenerate(argv[2], seed, stoul(optionValue(argc, argv, "--count", "1000")), min_pages, max_pages);
+        return runBenchmarkSuite(seed, stoul(optionValue(argc, argv, "--count", "200")), min_pages, max_pages,
+                                 stoul(optionValue(argc, argv, "--repeat", "1")), hasFlag(argc, argv, "--json"));
+    }
+    // --profile-stages <corpus> [--skills a,b,c] [--gpa] [--repeat N] [--threads T] [--json]: latency
+    // quantiles of each analysis stage, by resume size
+    if (argc > 2 && string(argv[1]) == "--profile-stages")
+    {
+        optional<JobRequirements> job = jobFromOptions(argc, argv, required_skills);
+        if (!job)
+            return 1;
+        return runStageProfile(argv[2], *job,
+                               stoul(optionValue(argc, argv, "--repeat", "10")),
+                               stoul(optionValue(argc, argv, "--threads", to_string(thread::hardware_concurrency()))),
+                               hasFlag(argc, argv, "--json"));
+    }
+    // --index-build <corpus> <index> [--skills a,b,c]: build a searchable index; the stored ATS score
+    // (used to break ties) is computed against --skills, or against no skills by default
+    if (argc > 3 && string(argv[1]) == "--index-build")
+    {
+        optional<JobRequirements> job = jobFromOptions(argc, argv, {});
+        if (!job)
+            return 1;
+        return runIndexBuild(argv[2], argv[3], *job);
+    }
+    // --index-query <index> <skill,skill,...> [--any] [--top N]: resumes with all (or any) of the skills
+    if (argc > 3 && string(argv[1]) == "--index-query")
+        return runIndexQuery(argv[2], splitList(argv[3]), !hasFlag(argc, argv, "--any"),
+                             stoul(optionValue(argc, argv, "--top", "20")));
+
     ResumeAnalyzer analyzer;
     ResumeAnalysisResult result = analyzer.analyzeResume(resumeText, required_skills, true);
 